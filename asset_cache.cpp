@@ -0,0 +1,342 @@
+#include "asset_cache.hpp"
+#include "utils.hpp"
+
+#include <algorithm>  // std::clamp, std::find, std::find_if
+#include <stdexcept>  // std::runtime_error
+
+// SDL_ttf isn't safe to use from several threads at once when opening or closing fonts (they share a FreeType library), so that's only ever done with this
+// locked. Images don't have that problem
+static std::mutex ttfMutex;
+
+// Closes a font, for the shared_ptrs holding fonts
+static void close_font(TTF_Font *font)
+{
+    std::lock_guard lock{ttfMutex};
+    TTF_CloseFont(font);
+}
+
+asset_cache::asset_cache(SDL_Renderer *renderer)
+    : m_renderer{renderer}
+{
+}
+
+asset_cache::~asset_cache()
+{
+    {
+        std::lock_guard lock{m_mutex};
+        m_stopWorkers = true;
+    }
+    m_wakeWorkers.notify_all();
+    for (std::thread &thread : m_workers)
+        thread.join();
+
+    // Anything that was loaded but never uploaded is let go of
+    auto freeJob = [](load_job &job)
+    {
+        if (job.surface)
+            SDL_FreeSurface(job.surface);
+        if (job.font)
+            close_font(job.font);
+        for (SDL_Surface *surface : job.spriteSurfaces)
+            SDL_FreeSurface(surface);
+    };
+    for (load_job &job : m_finished)
+        freeJob(job);
+    for (load_job &job : m_toUpload)
+        freeJob(job);
+}
+
+template<typename Map, typename Key>
+typename Map::mapped_type asset_cache::find_or_load(Map &map, const Key &key, auto &&load)
+{
+    auto iter = map.find(key);
+    if (iter != map.end()) {
+        ++m_stats.hits;
+        return iter->second;
+    }
+
+    // Time the loading, so that we know how much the cache saves. Loading an atlas loads its font as well, that time is already counted by the inner
+    // call, so it's taken out
+    uint64_t start = sdlCallUnchecked(SDL_GetPerformanceCounter)();
+    double nestedBefore = m_stats.loadSeconds;
+    typename Map::mapped_type asset = load();
+    double elapsed = (double)(sdlCallUnchecked(SDL_GetPerformanceCounter)() - start) / sdlCallUnchecked(SDL_GetPerformanceFrequency)();
+    m_stats.loadSeconds += elapsed - (m_stats.loadSeconds - nestedBefore);
+    ++m_stats.loads;
+
+    map.emplace(key, asset);
+    return asset;
+}
+
+std::shared_ptr<SDL_Texture> asset_cache::texture(const std::string &path)
+{
+    return find_or_load(m_textures, path, [&]()
+    {
+        // The shared_ptr destroys the texture once the last handle is gone
+        return std::shared_ptr<SDL_Texture>{sdlCall(IMG_LoadTexture)(m_renderer, path.c_str()), SDL_DestroyTexture};
+    });
+}
+
+std::shared_ptr<TTF_Font> asset_cache::font(const std::string &path, int size)
+{
+    return find_or_load(m_fonts, std::pair{path, size}, [&]()
+    {
+        std::lock_guard lock{ttfMutex};
+        return std::shared_ptr<TTF_Font>{sdlCall(TTF_OpenFont)(path.c_str(), size), close_font};
+    });
+}
+
+std::shared_ptr<const font_atlas> asset_cache::atlas(const std::string &path, int size)
+{
+    return find_or_load(m_atlases, std::pair{path, size}, [&]()
+    {
+        return std::make_shared<const font_atlas>(m_renderer, font(path, size).get());
+    });
+}
+
+std::shared_ptr<const sprite_atlas> asset_cache::sprites(const std::vector<std::string> &paths)
+{
+    return find_or_load(m_spriteAtlases, paths, [&]()
+    {
+        return std::make_shared<const sprite_atlas>(m_renderer, paths);
+    });
+}
+
+void asset_cache::worker()
+{
+    std::unique_lock lock{m_mutex};
+    while (true) {
+        m_wakeWorkers.wait(lock, [&]() { return m_stopWorkers || !m_jobs.empty(); });
+        if (m_stopWorkers)
+            return;
+        load_job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+
+        // The slow part is done without holding the lock, so that the other workers (and the main thread) can go on
+        lock.unlock();
+        try {
+            if (!job.sprites.empty()) {
+                for (const std::string &path : job.sprites)
+                    job.spriteSurfaces.push_back(sdlCall(IMG_Load)(path.c_str()));
+            } else if (job.size == 0) {
+                job.surface = sdlCall(IMG_Load)(job.path.c_str());
+            } else {
+                std::lock_guard ttfLock{ttfMutex};
+                job.font = sdlCall(TTF_OpenFont)(job.path.c_str(), job.size);
+            }
+        } catch (const sdl_error &error) {
+            // The error message belongs to SDL, and it's different for every thread, so it has to be copied before the main thread gets to it. For a
+            // sprite atlas, the image that failed is the one after the ones that were loaded
+            const std::string &path = job.sprites.empty() ? job.path : job.sprites[job.spriteSurfaces.size()];
+            job.error = std::string("couldn't load ") + path + ": " + error.what();
+        }
+        lock.lock();
+
+        m_finished.push_back(std::move(job));
+    }
+}
+
+unsigned asset_cache::load_async(const asset_manifest &manifest, std::function<void(std::size_t, std::size_t)> onProgress, std::function<void()> onDone)
+{
+    // Queue everything that isn't loaded yet (or being loaded already)
+    std::vector<load_job> jobs;
+    for (const std::string &path : manifest.textures)
+        if (!m_textures.contains(path) && m_inFlight.insert({ path, 0 }).second)
+            jobs.push_back({ path });
+    for (const auto &[path, size] : manifest.fonts)
+        if (!m_fonts.contains({ path, size }) && m_inFlight.insert({ path, size }).second)
+            jobs.push_back({ path, size });
+    for (const std::vector<std::string> &paths : manifest.spriteAtlases)
+        if (!m_spriteAtlases.contains(paths) && m_spritesInFlight.insert(paths).second)
+            jobs.push_back({ .sprites = paths });
+
+    if (!jobs.empty()) {
+        {
+            std::lock_guard lock{m_mutex};
+            for (load_job &job : jobs)
+                m_jobs.push_back(std::move(job));
+        }
+        m_wakeWorkers.notify_all();
+
+        // The workers are started the first time they're needed. One core is left for the main thread
+        if (m_workers.empty()) {
+            unsigned count = std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1;
+            for (unsigned i = 0; i < count; ++i)
+                m_workers.emplace_back(&asset_cache::worker, this);
+        }
+    }
+
+    m_requests.push_back({ ++m_lastRequestID, manifest, std::move(onProgress), std::move(onDone) });
+    return m_lastRequestID;
+}
+
+void asset_cache::cancel(unsigned request)
+{
+    // The files keep loading (something else might need them), only the callbacks are forgotten
+    std::erase_if(m_requests, [&](const async_request &r) { return r.id == request; });
+}
+
+void asset_cache::upload(load_job &job)
+{
+    if (job.sprites.empty())
+        m_inFlight.erase({ job.path, job.size });
+    else
+        m_spritesInFlight.erase(job.sprites);
+    if (!job.error.empty()) {
+        // The requests that needed it will never finish, so they're dropped (along with the sprites that did get loaded)
+        for (SDL_Surface *surface : job.spriteSurfaces)
+            SDL_FreeSurface(surface);
+        job.spriteSurfaces.clear();
+        std::erase_if(m_requests, [&](const async_request &request)
+        {
+            const asset_manifest &manifest = request.manifest;
+            if (!job.sprites.empty())
+                return std::find(manifest.spriteAtlases.begin(), manifest.spriteAtlases.end(), job.sprites) != manifest.spriteAtlases.end();
+            if (job.size == 0)
+                return std::find(manifest.textures.begin(), manifest.textures.end(), job.path) != manifest.textures.end();
+            return std::find(manifest.fonts.begin(), manifest.fonts.end(), std::pair{job.path, job.size}) != manifest.fonts.end();
+        });
+        throw std::runtime_error(job.error);
+    }
+
+    uint64_t start = sdlCallUnchecked(SDL_GetPerformanceCounter)();
+    if (!job.sprites.empty()) {
+        // The atlas takes over the surfaces (and frees them even if it throws), so they're taken out of the job first
+        std::vector<SDL_Surface*> surfaces = std::move(job.spriteSurfaces);
+        job.spriteSurfaces.clear();
+        m_spriteAtlases.emplace(job.sprites, std::make_shared<const sprite_atlas>(m_renderer, job.sprites, surfaces));
+    } else if (job.size == 0) {
+        SDL_Texture *texture = sdlCall(SDL_CreateTextureFromSurface)(m_renderer, job.surface);
+        sdlCall(SDL_FreeSurface)(job.surface);
+        job.surface = NULL;
+        m_textures.emplace(job.path, std::shared_ptr<SDL_Texture>{texture, SDL_DestroyTexture});
+    } else {
+        m_fonts.emplace(std::pair{job.path, job.size}, std::shared_ptr<TTF_Font>{job.font, close_font});
+        job.font = NULL;
+    }
+    m_stats.loadSeconds += (double)(sdlCallUnchecked(SDL_GetPerformanceCounter)() - start) / sdlCallUnchecked(SDL_GetPerformanceFrequency)();
+    ++m_stats.loads;
+}
+
+std::size_t asset_cache::loaded_count(const asset_manifest &manifest) const
+{
+    // A font counts as loaded once its atlas is made
+    std::size_t count = 0;
+    for (const std::string &path : manifest.textures)
+        count += m_textures.contains(path);
+    for (const auto &[path, size] : manifest.fonts)
+        count += m_atlases.contains({ path, size });
+    for (const std::vector<std::string> &paths : manifest.spriteAtlases)
+        count += m_spriteAtlases.contains(paths);
+    return count;
+}
+
+void asset_cache::pump(double budgetSeconds)
+{
+    // Pick up whatever the workers have finished
+    {
+        std::lock_guard lock{m_mutex};
+        for (load_job &job : m_finished)
+            m_toUpload.push_back(std::move(job));
+        m_finished.clear();
+    }
+
+    // Upload as much as fits in the budget. At least one file is uploaded every frame, so that loading always moves forward
+    const uint64_t frequency = sdlCallUnchecked(SDL_GetPerformanceFrequency)();
+    const uint64_t start = sdlCallUnchecked(SDL_GetPerformanceCounter)();
+    auto outOfTime = [&]() { return (double)(sdlCallUnchecked(SDL_GetPerformanceCounter)() - start) / frequency > budgetSeconds; };
+    std::size_t uploaded = 0;
+    while (!m_toUpload.empty() && (uploaded == 0 || !outOfTime())) {
+        // Taken out of the list first, so that it's gone even if uploading it throws
+        load_job job = std::move(m_toUpload.front());
+        m_toUpload.erase(m_toUpload.begin());
+        upload(job);
+        ++uploaded;
+    }
+
+    // Font atlases are made on the main thread, as they're rendered to a texture -- again, only while there's time left
+    for (const async_request &request : m_requests)
+        for (const auto &[path, size] : request.manifest.fonts)
+            if (m_fonts.contains({ path, size }) && !m_atlases.contains({ path, size }) && (uploaded == 0 || !outOfTime())) {
+                atlas(path, size);
+                ++uploaded;
+            }
+
+    // Let the requests know how far along they are. A callback might start loading something else (which adds to m_requests) or cancel a request
+    // (which takes one out, maybe the one being called), so first everything to do is written down, and only then are the callbacks called -- each one
+    // looked up by its ID again, and copied out before it's called
+    struct progress_update
+    {
+        unsigned id;
+        std::size_t loaded, total;
+    };
+    std::vector<progress_update> progress;
+    std::vector<unsigned> done;
+    for (async_request &request : m_requests) {
+        std::size_t total = request.manifest.textures.size() + request.manifest.fonts.size() + request.manifest.spriteAtlases.size();
+        std::size_t loaded = loaded_count(request.manifest);
+        if (loaded != request.lastProgress && request.onProgress)
+            progress.push_back({ request.id, loaded, total });
+        request.lastProgress = loaded;
+        if (loaded == total)
+            done.push_back(request.id);
+    }
+
+    auto find = [&](unsigned id) { return std::find_if(m_requests.begin(), m_requests.end(), [&](const async_request &r) { return r.id == id; }); };
+    for (const progress_update &update : progress) {
+        auto iter = find(update.id);
+        if (iter == m_requests.end())
+            continue;  // Cancelled by an earlier callback
+        std::function<void(std::size_t, std::size_t)> onProgress = iter->onProgress;
+        onProgress(update.loaded, update.total);
+    }
+    for (unsigned id : done) {
+        auto iter = find(id);
+        if (iter == m_requests.end())
+            continue;
+        std::function<void()> onDone = std::move(iter->onDone);
+        m_requests.erase(iter);
+        if (onDone)
+            onDone();
+    }
+}
+
+bool asset_cache::loading() const
+{
+    return !m_requests.empty();
+}
+
+void asset_cache::preload(const asset_manifest &manifest)
+{
+    for (const std::string &path : manifest.textures)
+        texture(path);
+    for (const auto &[path, size] : manifest.fonts)
+        atlas(path, size);
+    for (const std::vector<std::string> &paths : manifest.spriteAtlases)
+        sprites(paths);
+}
+
+std::size_t asset_cache::trim()
+{
+    // An asset whose only owner is the cache isn't used anywhere. Atlases go first, as they don't hold on to their fonts
+    std::size_t count = 0;
+    auto trimMap = [&](auto &map)
+    {
+        std::erase_if(map, [&](const auto &entry)
+        {
+            bool unused = entry.second.use_count() == 1;
+            count += unused;
+            return unused;
+        });
+    };
+    trimMap(m_atlases);
+    trimMap(m_spriteAtlases);
+    trimMap(m_fonts);
+    trimMap(m_textures);
+    return count;
+}
+
+const asset_stats &asset_cache::stats() const
+{
+    return m_stats;
+}
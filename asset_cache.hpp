@@ -0,0 +1,123 @@
+#ifndef GAMES_ASSET_CACHE_HPP
+#define GAMES_ASSET_CACHE_HPP
+
+#include <memory>         // std::shared_ptr
+#include <string>         // std::string
+#include <vector>         // std::vector
+#include <utility>        // std::pair
+#include <map>            // std::map
+#include <unordered_map>  // std::unordered_map
+#include <set>            // std::set
+#include <deque>          // std::deque
+#include <functional>     // std::function
+#include <thread>         // std::thread
+#include <mutex>          // std::mutex
+#include <condition_variable>  // std::condition_variable
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "font_atlas.hpp"
+#include "sprite_atlas.hpp"
+
+// A list of assets to load ahead of time (see asset_cache::preload)
+struct asset_manifest
+{
+    std::vector<std::string> textures = {};  // Image paths
+    std::vector<std::pair<std::string, int>> fonts = {};  // Font paths and sizes. Their font atlases are made too
+    std::vector<std::vector<std::string>> spriteAtlases = {};  // Lists of image paths, each packed into a sprite atlas
+};
+
+// How much work the cache did, and how much it saved
+struct asset_stats
+{
+    unsigned loads = 0;  // How many assets were loaded from disk (or, for font atlases, rendered)
+    unsigned hits = 0;  // How many times an asset was asked for and was already loaded
+    double loadSeconds = 0.0;  // The total time the main thread spent loading (for assets loaded in the background, that's only the upload)
+};
+
+// Loads the textures and fonts used by the scenes, each (path, size) only once. The assets are handed out as shared_ptrs, so that they stay alive for as
+// long as any scene uses them -- and the cache itself holds on to them as well, so that a scene that's left and entered again doesn't load anything.
+// Assets that nobody else is using can be let go of with trim(). The cache is owned by the scenes object (see scenes::assets).
+// Assets can also be loaded in the background (see load_async): worker threads read and decode the files, and the main thread only uploads the results
+// to the GPU, a few at a time, in pump() -- which scenes::mainloop calls once per frame.
+class asset_cache final
+{
+    SDL_Renderer *const m_renderer;  // The renderer the textures are made for
+
+    std::unordered_map<std::string, std::shared_ptr<SDL_Texture>> m_textures;
+    std::map<std::pair<std::string, int>, std::shared_ptr<TTF_Font>> m_fonts;
+    std::map<std::pair<std::string, int>, std::shared_ptr<const font_atlas>> m_atlases;
+    std::map<std::vector<std::string>, std::shared_ptr<const sprite_atlas>> m_spriteAtlases;
+    asset_stats m_stats;
+
+    // A file for the workers to load: an image if size is 0, a font otherwise -- or, if sprites isn't empty, all the images of a sprite atlas (and path
+    // and size aren't used). When it's done, the surface (or font, or sprite surfaces) is filled in -- or the error, if it couldn't be loaded
+    struct load_job
+    {
+        std::string path = {};
+        int size = 0;
+        std::vector<std::string> sprites = {};
+        SDL_Surface *surface = NULL;
+        TTF_Font *font = NULL;
+        std::vector<SDL_Surface*> spriteSurfaces = {};  // In the same order as sprites
+        std::string error = {};
+    };
+    // A load_async call that hasn't finished yet
+    struct async_request
+    {
+        unsigned id;
+        asset_manifest manifest;
+        std::function<void(std::size_t, std::size_t)> onProgress;
+        std::function<void()> onDone;
+        std::size_t lastProgress = -1;
+    };
+
+    // The workers, and what's shared with them. Everything below the mutex is only touched with the mutex locked
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeWorkers;
+    bool m_stopWorkers = false;
+    std::deque<load_job> m_jobs;  // What's left for the workers to do
+    std::vector<load_job> m_finished;  // What the workers are done with, waiting for the main thread to pick up
+    // Only touched by the main thread
+    std::vector<load_job> m_toUpload;  // Files that are loaded, but not uploaded yet (there wasn't enough time left in the frame)
+    std::set<std::pair<std::string, int>> m_inFlight;  // Every file being loaded in the background, so that nothing is loaded twice
+    std::set<std::vector<std::string>> m_spritesInFlight;  // The same for sprite atlases
+    std::vector<async_request> m_requests;
+    unsigned m_lastRequestID = 0;
+
+    // Finds an asset in one of the maps, or creates it with load() and remembers it. Keeps the stats up to date
+    template<typename Map, typename Key>
+    typename Map::mapped_type find_or_load(Map &map, const Key &key, auto &&load);
+
+    void worker();  // What every worker thread runs
+    void upload(load_job &job);  // Turns a loaded file into an asset (on the main thread). For sprites, that's packing them into their atlas
+    std::size_t loaded_count(const asset_manifest &manifest) const;  // How many assets of the manifest are ready
+
+public:
+    asset_cache(SDL_Renderer *renderer);
+    asset_cache(const asset_cache &) = delete;  // We don't allow copying it
+    ~asset_cache();  // Stops the workers, and lets go of anything they loaded that wasn't used
+
+    std::shared_ptr<SDL_Texture> texture(const std::string &path);  // Gives the texture loaded from an image file
+    std::shared_ptr<TTF_Font> font(const std::string &path, int size);  // Gives the font loaded from a font file, at the given size
+    std::shared_ptr<const font_atlas> atlas(const std::string &path, int size);  // Gives the font atlas of a font (see font_atlas.hpp)
+    std::shared_ptr<const sprite_atlas> sprites(const std::vector<std::string> &paths);  // Gives the images packed into a sprite atlas (see sprite_atlas.hpp)
+
+    void preload(const asset_manifest &manifest);  // Loads everything in the manifest, so that asking for it later is instant
+
+    // Loads everything in the manifest in the background. onProgress(loaded, total) is called whenever more of it is ready, and onDone() once all of it is
+    // (both from pump(), on the main thread). If everything is already loaded, onDone() is called on the next pump(). Loading errors are thrown from pump().
+    // Gives back a number for the request, to cancel() it with -- which has to be done if the callbacks can't be called anymore (say, their scene is gone)
+    unsigned load_async(const asset_manifest &manifest, std::function<void(std::size_t, std::size_t)> onProgress, std::function<void()> onDone);
+    void cancel(unsigned request);
+    // Uploads the files that the workers are done with, for at most about budgetSeconds, and calls the callbacks of load_async. Called once per frame
+    void pump(double budgetSeconds);
+    bool loading() const;  // Whether anything is being loaded in the background
+    std::size_t trim();  // Lets go of every asset that isn't used outside of the cache. Returns how many were let go of
+    const asset_stats &stats() const;
+};
+
+#endif  // GAMES_ASSET_CACHE_HPP
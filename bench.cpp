@@ -0,0 +1,1181 @@
+#include "bench.hpp"
+#include "utils.hpp"
+#include "render_queue.hpp"
+#include "pong/headless.hpp"
+#include "dungeon/tilemap.hpp"
+#include "dungeon/room_graph.hpp"
+#include "dungeon/generator.hpp"
+#include "dungeon/raster.hpp"
+#include "dungeon/pathfinder.hpp"
+#include "dungeon/field_of_view.hpp"
+#include "dungeon/tile_renderer.hpp"
+
+#include <chrono>      // std::chrono::steady_clock
+#include <iostream>    // std::cout
+#include <iomanip>     // std::setw
+#include <random>      // std::minstd_rand
+#include <vector>      // std::vector
+#include <string>      // std::string, std::to_string
+#include <stdexcept>   // std::logic_error, std::length_error
+#include <cstdlib>     // std::abs
+#include <cstdint>     // uint64_t
+#include <cstddef>     // std::size_t
+#include <climits>     // INT_MIN, INT_MAX
+#include <initializer_list>  // std::initializer_list
+#include <thread>      // std::thread
+#include <array>       // std::array
+#include <tuple>       // std::tuple
+#include <algorithm>   // std::min, std::max, std::sort
+
+// The SIMD intrinsics used by rect_set. Every x86-64 CPU has SSE2, AVX2 is only used if the compiler is told it may (-mavx2)
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Runs func `iterations` times and gives back the average time that one run took, in nanoseconds. It's a template (and not an std::function) so
+// that the call can be inlined, and doesn't add to the measured time.
+static double time_per_run(uint64_t iterations, const auto &func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i)
+        func();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+// Prints a single line of results
+static void report(std::string_view what, double value, std::string_view unit = "ns")
+{
+    std::cout << "  " << std::left << std::setw(48) << what << std::right << std::setw(10) << std::fixed << std::setprecision(2) << value << " " << unit << std::endl;
+}
+
+// Written to by the benchmarks, so that the compiler can't optimize the measured code away
+static volatile uint64_t sink;
+
+
+// The SIMD overlap kernel, and the aabb_overlap_all functions built on it. The pong game used them for its collisions until every entity got a single
+// bounding box, found through collision_grid and checked with plain aabb_overlap -- so they're only kept here, next to their benchmark.
+
+// Helper function to check if any rectangle of one list overlaps any rectangle of another list. Rectangles from the same list aren't checked against
+// each other, and nothing is allocated.
+bool aabb_overlap_all(const auto &rectsList1, const auto &rectsList2)
+{
+    for (const SDL_Rect &rect1 : rectsList1)
+        for (const SDL_Rect &rect2 : rectsList2)
+            if (aabb_overlap(rect1, rect2))
+                return true;
+    return false;
+}
+
+// A set of up to Capacity rectangles, stored as a "structure of arrays": all the left edges are next to each other in memory, then all the top edges, and
+// so on. That layout lets a single rectangle be checked against 4 (SSE2) or 8 (AVX2) rectangles of the set with one instruction per comparison. The
+// storage is a plain array inside the object, so a rect_set never allocates.
+template<std::size_t Capacity>
+class rect_set
+{
+    static_assert(Capacity > 0 && Capacity <= 64, "the overlap masks are 64-bit, so a rect_set holds at most 64 rectangles");
+
+    // The arrays are padded to a multiple of 8, so that the SIMD loops can always work on whole vectors. The unused slots hold rectangles that can't
+    // overlap anything.
+    static constexpr std::size_t s_lanes = (Capacity + 7) / 8 * 8;
+    alignas(32) int m_x1[s_lanes], m_y1[s_lanes], m_x2[s_lanes], m_y2[s_lanes];  // The left, top, right and bottom edges (inclusive, like in aabb_overlap)
+    std::size_t m_size = 0;
+
+public:
+    rect_set()
+    {
+        clear();
+    }
+
+    rect_set(std::initializer_list<SDL_Rect> rects)
+        : rect_set{}
+    {
+        for (const SDL_Rect &rect : rects)
+            push_back(rect);
+    }
+
+    // Removes every rectangle from the set
+    void clear()
+    {
+        // An "inside-out" rectangle, with its left edge to the right of everything and its right edge to the left of everything, never overlaps anything
+        for (std::size_t i = 0; i < s_lanes; ++i) {
+            m_x1[i] = m_y1[i] = INT_MAX;
+            m_x2[i] = m_y2[i] = INT_MIN;
+        }
+        m_size = 0;
+    }
+
+    // Adds a rectangle to the set. Throws std::length_error if the set is full
+    void push_back(const SDL_Rect &rect)
+    {
+        if (m_size == Capacity)
+            throw std::length_error("rect_set is full");
+        m_x1[m_size] = rect.x;
+        m_y1[m_size] = rect.y;
+        m_x2[m_size] = rect.x + rect.w;
+        m_y2[m_size] = rect.y + rect.h;
+        ++m_size;
+    }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    // Gives back the i-th rectangle of the set
+    SDL_Rect operator[](std::size_t i) const
+    {
+        return { m_x1[i], m_y1[i], m_x2[i] - m_x1[i], m_y2[i] - m_y1[i] };
+    }
+
+    // Checks the given rectangle against every rectangle of the set. Bit i of the result is set if it overlaps the i-th rectangle.
+    uint64_t overlap_mask(const SDL_Rect &rect) const
+    {
+        const int x1 = rect.x, y1 = rect.y, x2 = rect.x + rect.w, y2 = rect.y + rect.h;
+        uint64_t mask = 0;
+        // Two rectangles are apart if one of them ends before the other one starts, on either axis. That's 4 comparisons, and they're the same for
+        // every rectangle in the set, so they can be done side by side.
+#if defined(__AVX2__)
+        const __m256i rx1 = _mm256_set1_epi32(x1), ry1 = _mm256_set1_epi32(y1), rx2 = _mm256_set1_epi32(x2), ry2 = _mm256_set1_epi32(y2);
+        for (std::size_t i = 0; i < m_size; i += 8) {
+            __m256i apart = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_load_si256((const __m256i *)(m_x1 + i)), rx2), _mm256_cmpgt_epi32(rx1, _mm256_load_si256((const __m256i *)(m_x2 + i)))),
+                _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_load_si256((const __m256i *)(m_y1 + i)), ry2), _mm256_cmpgt_epi32(ry1, _mm256_load_si256((const __m256i *)(m_y2 + i))))
+            );
+            mask |= (uint64_t)(~_mm256_movemask_ps(_mm256_castsi256_ps(apart)) & 0xFF) << i;
+        }
+#elif defined(__SSE2__)
+        const __m128i rx1 = _mm_set1_epi32(x1), ry1 = _mm_set1_epi32(y1), rx2 = _mm_set1_epi32(x2), ry2 = _mm_set1_epi32(y2);
+        for (std::size_t i = 0; i < m_size; i += 4) {
+            __m128i apart = _mm_or_si128(
+                _mm_or_si128(_mm_cmpgt_epi32(_mm_load_si128((const __m128i *)(m_x1 + i)), rx2), _mm_cmpgt_epi32(rx1, _mm_load_si128((const __m128i *)(m_x2 + i)))),
+                _mm_or_si128(_mm_cmpgt_epi32(_mm_load_si128((const __m128i *)(m_y1 + i)), ry2), _mm_cmpgt_epi32(ry1, _mm_load_si128((const __m128i *)(m_y2 + i))))
+            );
+            mask |= (uint64_t)(~_mm_movemask_ps(_mm_castsi128_ps(apart)) & 0xF) << i;
+        }
+#else
+        for (std::size_t i = 0; i < m_size; ++i) {
+            bool apart = (m_x1[i] > x2) | (x1 > m_x2[i]) | (m_y1[i] > y2) | (y1 > m_y2[i]);
+            mask |= (uint64_t)!apart << i;
+        }
+#endif
+        // The padding never overlaps anything, so there's no need to mask it out
+        return mask;
+    }
+
+    // Checks every rectangle of another set against every rectangle of this one. Bit i of the result is set if the i-th rectangle of this set overlaps
+    // any rectangle of the other set.
+    template<std::size_t OtherCapacity>
+    uint64_t overlap_mask(const rect_set<OtherCapacity> &other) const
+    {
+        uint64_t mask = 0;
+        for (std::size_t i = 0; i < other.size(); ++i)
+            mask |= overlap_mask(other[i]);
+        return mask;
+    }
+};
+
+// The rect_set version of aabb_overlap_all -- it stops at the first rectangle of the second set that overlaps anything in the first one
+template<std::size_t Capacity1, std::size_t Capacity2>
+bool aabb_overlap_all(const rect_set<Capacity1> &rects1, const rect_set<Capacity2> &rects2)
+{
+    for (std::size_t i = 0; i < rects2.size(); ++i)
+        if (rects1.overlap_mask(rects2[i]))
+            return true;
+    return false;
+}
+
+
+// The rectangle overlap functions, as they were before rect_set was introduced. They're kept here to compare against.
+namespace reference
+{
+    static bool aabb_overlap(const SDL_Rect &rect1, const SDL_Rect &rect2)
+    {
+        auto checkContainedInRange = [](int start, int end, int num)
+        {
+            return num >= start && num <= end;
+        };
+        bool overlapX = checkContainedInRange(rect1.x, rect1.x + rect1.w, rect2.x);
+        overlapX |= checkContainedInRange(rect1.x, rect1.x + rect1.w, rect2.x + rect2.w);
+        overlapX |= checkContainedInRange(rect2.x, rect2.x + rect2.w, rect1.x);
+        overlapX |= checkContainedInRange(rect2.x, rect2.x + rect2.w, rect1.x + rect1.w);
+
+        bool overlapY = checkContainedInRange(rect1.y, rect1.y + rect1.h, rect2.y);
+        overlapY |= checkContainedInRange(rect1.y, rect1.y + rect1.h, rect2.y + rect2.h);
+        overlapY |= checkContainedInRange(rect2.y, rect2.y + rect2.h, rect1.y);
+        overlapY |= checkContainedInRange(rect2.y, rect2.y + rect2.h, rect1.y + rect1.h);
+
+        return overlapX && overlapY;
+    }
+
+    static bool aabb_overlap_all(const std::vector<SDL_Rect> &rectsList1, const std::vector<SDL_Rect> &rectsList2)
+    {
+        std::vector<SDL_Rect> rects;
+        rects.insert(rects.end(), std::begin(rectsList1), std::end(rectsList1));
+        rects.insert(rects.end(), std::begin(rectsList2), std::end(rectsList2));
+        for (const SDL_Rect &rect1 : rects)
+            for (const SDL_Rect &rect2 : rects) {
+                if (&rect1 == &rect2)
+                    continue;
+                if (reference::aabb_overlap(rect1, rect2))
+                    return true;
+            }
+        return false;
+    }
+}
+
+// Compares the old and new rectangle overlap functions: one rectangle against 64, and the two-list aabb_overlap_all on lists of the sizes the pong
+// game used to check (1 rectangle for the ball, 2 for a goal)
+static void bench_aabb()
+{
+    std::minstd_rand random{1};
+    auto randomRect = [&]() { return SDL_Rect{ (int)(random() % 1000), (int)(random() % 800), (int)(random() % 64), (int)(random() % 64) }; };
+
+    std::vector<SDL_Rect> many;
+    rect_set<64> manySet;
+    for (int i = 0; i < 64; ++i) {
+        many.push_back(randomRect());
+        manySet.push_back(many.back());
+    }
+    std::vector<SDL_Rect> queries;
+    for (int i = 0; i < 1024; ++i)
+        queries.push_back(randomRect());
+
+    // Make sure that all the versions agree before timing them
+    for (const SDL_Rect &query : queries) {
+        uint64_t mask = 0;
+        for (int i = 0; i < 64; ++i)
+            mask |= (uint64_t)reference::aabb_overlap(query, many[i]) << i;
+        if (mask != manySet.overlap_mask(query))
+            throw std::logic_error("rect_set::overlap_mask disagrees with the original aabb_overlap");
+        for (int i = 0; i < 64; ++i)
+            if (reference::aabb_overlap(query, many[i]) != aabb_overlap(query, many[i]))
+                throw std::logic_error("aabb_overlap disagrees with the original aabb_overlap");
+    }
+
+    std::cout << "aabb: 1 rectangle against 64 (per query)" << std::endl;
+    std::size_t q = 0;
+    report("original aabb_overlap, 64 calls", time_per_run(1'000'000, [&]()
+    {
+        const SDL_Rect &query = queries[q++ % queries.size()];
+        uint64_t mask = 0;
+        for (int i = 0; i < 64; ++i)
+            mask |= (uint64_t)reference::aabb_overlap(query, many[i]) << i;
+        sink = mask;
+    }));
+    report("branchless aabb_overlap, 64 calls", time_per_run(1'000'000, [&]()
+    {
+        const SDL_Rect &query = queries[q++ % queries.size()];
+        uint64_t mask = 0;
+        for (int i = 0; i < 64; ++i)
+            mask |= (uint64_t)aabb_overlap(query, many[i]) << i;
+        sink = mask;
+    }));
+    report("rect_set<64>::overlap_mask", time_per_run(1'000'000, [&]()
+    {
+        sink = manySet.overlap_mask(queries[q++ % queries.size()]);
+    }));
+
+    std::cout << "aabb: 1 rectangle list against a 2 rectangle list (per call)" << std::endl;
+    std::vector<std::vector<SDL_Rect>> singles, pairs;
+    std::vector<rect_set<4>> singleSets, pairSets;
+    for (int i = 0; i < 1024; ++i) {
+        singles.push_back({ randomRect() });
+        pairs.push_back({ randomRect(), randomRect() });
+        singleSets.push_back({ singles.back()[0] });
+        pairSets.push_back({ pairs.back()[0], pairs.back()[1] });
+    }
+    report("original aabb_overlap_all (merges the lists)", time_per_run(5'000'000, [&]()
+    {
+        sink = reference::aabb_overlap_all(singles[q % 1024], pairs[(q * 7) % 1024]);
+        ++q;
+    }));
+    report("aabb_overlap_all on std::vector", time_per_run(5'000'000, [&]()
+    {
+        sink = aabb_overlap_all(singles[q % 1024], pairs[(q * 7) % 1024]);
+        ++q;
+    }));
+    report("aabb_overlap_all on rect_set<4>", time_per_run(5'000'000, [&]()
+    {
+        sink = aabb_overlap_all(singleSets[q % 1024], pairSets[(q * 7) % 1024]);
+        ++q;
+    }));
+}
+
+
+// Checks that updating a pong (or hockey) game doesn't allocate any memory once it's warmed up, and shows how long a tick takes. Throws if anything
+// was allocated.
+static void bench_alloc()
+{
+    for (bool hockeyMode : { false, true }) {
+        pong_world world{NULL, NULL, NULL, hockeyMode};
+        std::minstd_rand random{1};
+        input_state input;
+
+        // The warm-up lets every container grow to the size it needs, and lets every key get pressed at least once
+        uint64_t tick = 0;
+        for (; tick < 10'000; ++tick) {
+            if (tick % 20 == 0)
+                press_random_keys(world, input, random);
+            world.update(1 / 60.0f, input);
+        }
+
+        const uint64_t ticks = 200'000;
+        unsigned points = world.rallies().rallies;
+        uint64_t before = allocationCount;
+        double perTick = time_per_run(ticks, [&]()
+        {
+            if (tick++ % 20 == 0)
+                press_random_keys(world, input, random);
+            world.update(1 / 60.0f, input);
+        });
+        uint64_t allocations = allocationCount - before;
+        points = world.rallies().rallies - points;
+
+        std::cout << "alloc: " << (hockeyMode ? "hockey" : "pong") << ", " << ticks << " ticks (" << points << " points scored)" << std::endl;
+        report("heap allocations per tick", (double)allocations / ticks, "");
+        report("time per tick", perTick);
+        if (allocations != 0)
+            throw std::logic_error("the game allocated memory in steady state");
+    }
+}
+
+
+// Shows how much each sdlCall checking mode (see sdl_check in utils.hpp) adds to a call. The functions called are ones that do almost nothing and don't
+// need SDL to be initialized, so that the time is mostly the checking: SDL_HasIntersection returns an SDL_bool (never checked by return code), and
+// SDL_GetNumRenderDrivers returns an int (checked for being negative).
+static void bench_sdlcall()
+{
+    SDL_Rect rect1 = { 0, 0, 10, 10 }, rect2 = { 5, 5, 10, 10 };
+    const uint64_t calls = 10'000'000;
+
+    std::cout << "sdlcall: per call (this build uses ";
+    std::cout << (SDL_CHECK == sdl_check::full ? "full" : SDL_CHECK == sdl_check::return_code ? "return_code" : "none") << " checking)" << std::endl;
+    report("SDL_HasIntersection, plain call", time_per_run(calls, [&]() { sink = SDL_HasIntersection(&rect1, &rect2); }));
+    report("SDL_HasIntersection, sdl_check::none", time_per_run(calls, [&]() { sink = sdlCall<sdl_check::none>(SDL_HasIntersection)(&rect1, &rect2); }));
+    report("SDL_HasIntersection, sdl_check::return_code", time_per_run(calls, [&]() { sink = sdlCall<sdl_check::return_code>(SDL_HasIntersection)(&rect1, &rect2); }));
+    report("SDL_HasIntersection, sdl_check::full", time_per_run(calls, [&]() { sink = sdlCall<sdl_check::full>(SDL_HasIntersection)(&rect1, &rect2); }));
+    report("SDL_GetNumRenderDrivers, plain call", time_per_run(calls, [&]() { sink = SDL_GetNumRenderDrivers(); }));
+    report("SDL_GetNumRenderDrivers, sdl_check::none", time_per_run(calls, [&]() { sink = sdlCall<sdl_check::none>(SDL_GetNumRenderDrivers)(); }));
+    report("SDL_GetNumRenderDrivers, sdl_check::return_code", time_per_run(calls, [&]() { sink = sdlCall<sdl_check::return_code>(SDL_GetNumRenderDrivers)(); }));
+    report("SDL_GetNumRenderDrivers, sdl_check::full", time_per_run(calls, [&]() { sink = sdlCall<sdl_check::full>(SDL_GetNumRenderDrivers)(); }));
+}
+
+
+// Draws a 64x48 grid of 16x16 tiles in 4 colors (the dungeon crawler's map), onto a software renderer -- once by calling the renderer for every tile,
+// and once through the render queue, which sorts them by color and draws each color with one SDL_RenderFillRects call. The software renderer draws
+// into an SDL_Surface, so no window is needed.
+static void bench_render()
+{
+    SDL_Surface *surface = sdlCall(SDL_CreateRGBSurfaceWithFormat)(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer *renderer = sdlCall(SDL_CreateSoftwareRenderer)(surface);
+
+    const SDL_Color palette[] = { { 0, 0, 0, 255 }, { 128, 128, 128, 255 }, { 128, 64, 0, 255 }, { 0, 0, 255, 255 } };
+    std::minstd_rand random{1};
+    std::vector<uint8_t> tiles(64 * 48);
+    for (uint8_t &tile : tiles)
+        tile = random() % 4;
+
+    std::cout << "render: 64x48 tiles in 4 colors (per frame)" << std::endl;
+    report("one SDL_RenderFillRect per tile", time_per_run(200, [&]()
+    {
+        for (int y = 0; y < 48; ++y)
+            for (int x = 0; x < 64; ++x) {
+                const SDL_Color &color = palette[tiles[y * 64 + x]];
+                SDL_Rect rect = { x * 16, y * 16, 16, 16 };
+                sdlCall(SDL_SetRenderDrawColor)(renderer, color.r, color.g, color.b, color.a);
+                sdlCall(SDL_RenderFillRect)(renderer, &rect);
+            }
+    }));
+    report("  draw calls", 64 * 48, "");
+    report("  color changes", 64 * 48, "");
+
+    render_queue queue;
+    report("render_queue", time_per_run(200, [&]()
+    {
+        queue.next_pass();
+        for (int y = 0; y < 48; ++y)
+            for (int x = 0; x < 64; ++x)
+                queue.fill_rect(0, { x * 16, y * 16, 16, 16 }, palette[tiles[y * 64 + x]]);
+        queue.flush(renderer);
+    }));
+    report("  draw calls", queue.last_frame().drawCalls, "");
+    report("  color changes", queue.last_frame().colorChanges, "");
+
+    SDL_DestroyRenderer(renderer);
+    sdlCall(SDL_FreeSurface)(surface);
+}
+
+
+// Draws tile maps of growing sizes with a tile_renderer, onto a software renderer, changing a single tile every frame (as a game would). Only that tile
+// is written into the texture, and the map is drawn with one textured quad, so the cost shouldn't grow much with the size of the map. A frame that
+// rewrites the whole map is measured as well, for comparison.
+static void bench_tilemap()
+{
+    SDL_Surface *surface = sdlCall(SDL_CreateRGBSurfaceWithFormat)(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer *renderer = sdlCall(SDL_CreateSoftwareRenderer)(surface);
+    render_queue queue;
+
+    std::cout << "tilemap: tile_renderer, one tile changed per frame (per frame)" << std::endl;
+    const int sizes[][2] = { { 64, 48 }, { 256, 192 }, { 1024, 768 } };
+    for (const auto &[width, height] : sizes) {
+        std::minstd_rand random{1};
+        std::vector<uint8_t> tiles(width * height);
+        for (uint8_t &tile : tiles)
+            tile = random() % 4;
+        auto tileAt = [&](int x, int y) { return tiles[y * width + x]; };
+
+        tile_renderer map{renderer, width, height};
+        map.set_color(0, { 0, 0, 0, 255 });
+        map.set_color(1, { 128, 128, 128, 255 });
+        map.set_color(2, { 128, 64, 0, 255 });
+        map.set_color(3, { 0, 0, 255, 255 });
+        map.upload(tileAt);
+
+        std::string label = std::to_string(width) + "x" + std::to_string(height);
+        report(label + ", one tile changed", time_per_run(200, [&]()
+        {
+            int x = random() % width, y = random() % height;
+            tiles[y * width + x] = random() % 4;
+            map.mark_dirty(x, y, x, y);
+            map.upload(tileAt);
+            queue.next_pass();
+            map.draw(queue, 0, { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT });
+            queue.flush(renderer);
+        }));
+        report(label + ", every tile changed", time_per_run(50, [&]()
+        {
+            map.mark_all_dirty();
+            map.upload(tileAt);
+            queue.next_pass();
+            map.draw(queue, 0, { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT });
+            queue.flush(renderer);
+        }));
+    }
+    report("  draw calls", queue.last_frame().drawCalls, "");
+
+    SDL_DestroyRenderer(renderer);
+    sdlCall(SDL_FreeSurface)(surface);
+}
+
+
+// Carves a few hundred random rooms into a 4096x4096 tilemap (16 million tiles), and reads it back. Only the chunks that the rooms touch take up
+// memory, so it shouldn't need anywhere near the 16 MB that a flat array would.
+static void bench_chunks()
+{
+    const int size = 4096, rooms = 300;
+    tilemap map{size, size};
+    std::minstd_rand random{1};
+
+    std::cout << "chunks: " << rooms << " rooms carved into a " << size << "x" << size << " tilemap" << std::endl;
+    uint64_t carved = 0;
+    report("carving a room, per tile", time_per_run(rooms, [&]()
+    {
+        int w = 4 + random() % 28, h = 4 + random() % 28;
+        int x1 = random() % (size - w), y1 = random() % (size - h);
+        for (int y = y1; y < y1 + h; ++y)
+            for (int x = x1; x < x1 + w; ++x)
+                map.set(x, y, 1);
+        carved += w * h;
+    }) * rooms / carved);
+
+    int x = 0, y = 0;
+    uint64_t reads = 1 << 22;
+    report("reading a random tile", time_per_run(reads, [&]()
+    {
+        x = (x + 2654435761u) & (size - 1);
+        y = (y + 40503u) & (size - 1);
+        sink = sink + map.at(x, y);
+    }));
+    report("  resident chunks", map.resident_chunks(), "");
+    report("  memory used", map.memory_used() / 1024.0, "KiB");
+    report("  memory of a flat array", (double)size * size / 1024.0, "KiB");
+}
+
+
+// The room lookups of the first draft of room_graph (in main.cpp), kept here to compare against: finding the room in a cell went through every room,
+// and finding a neighbor did that for every cell on the way to it.
+namespace reference
+{
+    static room_id at_cell(const std::vector<std::pair<int, int>> &rooms, int x, int y)
+    {
+        for (std::size_t i = 0; i < rooms.size(); ++i)
+            if (rooms[i].first == x && rooms[i].second == y)
+                return i;
+        return NO_ROOM;
+    }
+
+    static room_neighbor neighbor(const std::vector<std::pair<int, int>> &rooms, int width, int height, room_id id, direction dir)
+    {
+        int x = rooms[id].first + DIR_X[dir], y = rooms[id].second + DIR_Y[dir];
+        unsigned distance = 1;
+        while (x >= 0 && x < width && y >= 0 && y < height) {
+            room_id maybeNeighbor = reference::at_cell(rooms, x, y);
+            if (maybeNeighbor != NO_ROOM)
+                return { maybeNeighbor, distance };
+            x += DIR_X[dir];
+            y += DIR_Y[dir];
+            ++distance;
+        }
+        return {};
+    }
+}
+
+// Fills a 128x128 room graph with 4000 rooms, and compares finding their neighbors with the draft's way of doing it
+static void bench_rooms()
+{
+    const int size = 128, count = 4000;
+    std::minstd_rand random{1};
+    std::vector<std::pair<int, int>> positions;
+    std::vector<bool> taken(size * size);
+    while ((int)positions.size() < count) {
+        int x = random() % size, y = random() % size;
+        if (!taken[y * size + x]) {
+            taken[y * size + x] = true;
+            positions.push_back({ x, y });
+        }
+    }
+
+    room_graph graph{size, size};
+    std::cout << "rooms: " << count << " rooms on a " << size << "x" << size << " grid" << std::endl;
+    report("building the graph, per room", time_per_run(1, [&]()
+    {
+        graph.clear();
+        for (const auto &[x, y] : positions)
+            graph.add_room(x, y, x * 8, y * 8, x * 8 + 6, y * 8 + 6);
+    }) / count);
+
+    // Make sure that both ways agree before timing them
+    for (room_id id = 0; id < count; ++id)
+        for (int dir = 0; dir < 4; ++dir) {
+            room_neighbor expected = reference::neighbor(positions, size, size, id, (direction)dir);
+            const room_neighbor &got = graph.neighbor(id, (direction)dir);
+            if (got.room != expected.room || got.distance != expected.distance)
+                throw std::logic_error("room_graph disagrees with the original neighbor search");
+        }
+
+    room_id id = 0;
+    report("original neighbor search, 4 directions", time_per_run(2000, [&]()
+    {
+        for (int dir = 0; dir < 4; ++dir)
+            sink = sink + reference::neighbor(positions, size, size, id, (direction)dir).distance;
+        id = (id + 1) % count;
+    }));
+    report("room_graph::neighbor, 4 directions", time_per_run(1'000'000, [&]()
+    {
+        for (int dir = 0; dir < 4; ++dir)
+            sink = sink + graph.neighbor(id, (direction)dir).distance;
+        id = (id + 1) % count;
+    }));
+    int x = 0, y = 0;
+    report("original at_cell", time_per_run(20000, [&]()
+    {
+        x = (x + 37) % size;
+        y = (y + 11) % size;
+        sink = sink + reference::at_cell(positions, x, y);
+    }));
+    report("room_graph::at_cell", time_per_run(10'000'000, [&]()
+    {
+        x = (x + 37) % size;
+        y = (y + 11) % size;
+        sink = sink + graph.at_cell(x, y);
+    }));
+}
+
+
+// Counts the separate groups of connected rooms by walking the graph, the way the draft's find_disjoint meant to (but with the rooms marked as visited,
+// so that it finishes on graphs with loops). Kept here to compare against.
+namespace reference
+{
+    static std::size_t count_disjoint(const room_graph &graph)
+    {
+        std::vector<bool> visited(graph.rooms().size());
+        std::vector<room_id> toVisit;
+        std::size_t groups = 0;
+        for (room_id start = 0; start < graph.rooms().size(); ++start) {
+            if (visited[start])
+                continue;
+            ++groups;
+            visited[start] = true;
+            toVisit.push_back(start);
+            while (!toVisit.empty()) {
+                room_id id = toVisit.back();
+                toVisit.pop_back();
+                for (uint32_t connection : graph.get(id).connections) {
+                    room_id other = graph.connections()[connection].other(id);
+                    if (!visited[other]) {
+                        visited[other] = true;
+                        toVisit.push_back(other);
+                    }
+                }
+            }
+        }
+        return groups;
+    }
+}
+
+// Puts 4000 rooms on a 128x128 grid, and connects random neighbors until the dungeon is one piece (or the corridors run out), asking how many pieces
+// are left after every corridor -- as a generator would. The union-find answers that straight away, walking the graph has to look at every room.
+static void bench_components()
+{
+    const int size = 128, count = 4000;
+    std::minstd_rand random{1};
+    room_graph graph{size, size};
+    while ((int)graph.rooms().size() < count) {
+        int x = random() % size, y = random() % size;
+        if (graph.at_cell(x, y) == NO_ROOM)
+            graph.add_room(x, y, x * 8, y * 8, x * 8 + 6, y * 8 + 6);
+    }
+
+    // The corridors are picked ahead of time, so that only adding them (and asking) is timed
+    std::vector<std::pair<room_id, room_id>> corridors;
+    for (int i = 0; i < count * 4; ++i) {
+        room_id id = random() % count;
+        const room_neighbor &next = graph.neighbor(id, (direction)(random() % 4));
+        if (next.room != NO_ROOM)
+            corridors.push_back({ id, next.room });
+    }
+
+    std::cout << "components: connecting " << count << " rooms, asking how many pieces are left after every corridor" << std::endl;
+    std::size_t added = 0;
+    report("room_graph::connect + component_count", time_per_run(1, [&]()
+    {
+        for (const auto &[room1, room2] : corridors) {
+            graph.connect(room1, room2, 0, 0, 0, 0);
+            ++added;
+            if (graph.component_count() == 1)
+                break;
+        }
+    }) / added);
+    report("  corridors until connected", added, "");
+    report("  pieces left", graph.component_count(), "");
+    if (reference::count_disjoint(graph) != graph.component_count() || graph.find_disjoint().size() != graph.component_count())
+        throw std::logic_error("room_graph disagrees with walking the graph about how many pieces there are");
+
+    report("walking the graph to count the pieces", time_per_run(100, [&]() { sink = reference::count_disjoint(graph); }));
+    report("room_graph::find_disjoint", time_per_run(100, [&]() { sink = graph.find_disjoint().size(); }));
+}
+
+
+// Sums up a generated dungeon into one number (FNV-1a over every resident chunk and every corridor), to check that two dungeons are the same
+static uint64_t dungeon_checksum(const tilemap &tiles, const room_graph &graph)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+    tiles.for_each_chunk([&](int cx, int cy, const tilemap::chunk &c)
+    {
+        add(cx);
+        add(cy);
+        for (uint8_t tile : c.tiles)
+            add(tile);
+    });
+    for (const room_connection &connection : graph.connections()) {
+        add(connection.room1);
+        add(connection.room2);
+    }
+    return hash;
+}
+
+// Generates dungeons of growing sizes, on 1 to 8 threads, and shows how many can be made per second. The same seed has to give the exact same dungeon
+// on any amount of threads, which is checked too.
+static void bench_dungeon()
+{
+    std::cout << "dungeon: generating dungeons (16x16 tile cells, " << std::thread::hardware_concurrency() << " cores)" << std::endl;
+    const int sizes[] = { 256, 1024, 4096 };
+    for (int size : sizes) {
+        tilemap tiles{size, size};
+        room_graph graph{size / 16, size / 16};
+        dungeon_settings settings;
+
+        generate_dungeon(tiles, graph, settings, 1);
+        uint64_t expected = dungeon_checksum(tiles, graph);
+        for (unsigned threads : { 2u, 3u, 8u }) {
+            generate_dungeon(tiles, graph, settings, threads);
+            if (dungeon_checksum(tiles, graph) != expected)
+                throw std::logic_error("the dungeon generator gave a different dungeon on " + std::to_string(threads) + " threads");
+        }
+
+        const uint64_t runs = std::max(2, 1024 * 1024 / (size * size));
+        std::string label = std::to_string(size) + "x" + std::to_string(size);
+        for (unsigned threads : { 1u, 2u, 4u, 8u }) {
+            double ns = time_per_run(runs, [&]()
+            {
+                generate_dungeon(tiles, graph, settings, threads);
+                ++settings.seed;
+            });
+            report(label + ", " + std::to_string(threads) + " thread(s)", 1e9 / ns, "maps/s");
+        }
+        report("  rooms", graph.rooms().size(), "");
+    }
+}
+
+
+// The drawing functions of the first version of the dungeon crawler scene, on its fixed 64x48 map, kept here to compare against
+namespace reference
+{
+    using tile_grid = std::array<std::array<uint8_t, 64>, 48>;
+
+    static int clip_x(int x)
+    {
+        return x < 0 ? 0 : (x > 63 ? 63 : x);
+    }
+
+    static int clip_y(int y)
+    {
+        return y < 0 ? 0 : (y > 47 ? 47 : y);
+    }
+
+    static void draw_rect(tile_grid &tiles, int x1, int y1, int x2, int y2, uint8_t fill)
+    {
+        if (x1 > x2)
+            std::swap(x1, x2);
+        if (y1 > y2)
+            std::swap(y1, y2);
+        for (int y = y1; y <= y2; ++y)
+            for (int x = x1; x <= x2; ++x)
+                tiles[y][x] = fill;
+    }
+
+    static void draw_hline(tile_grid &tiles, int x1, int x2, int y, uint8_t fill)
+    {
+        if (x2 < x1)
+            std::swap(x1, x2);
+        y = clip_y(y);
+        x1 = clip_x(x1);
+        x2 = clip_x(x2);
+
+        for (int x = x1; x <= x2; ++x) {
+            tiles[y][x] = fill;
+        }
+    }
+
+    static void draw_vline(tile_grid &tiles, int x, int y1, int y2, uint8_t fill)
+    {
+        if (y2 < y1)
+            std::swap(y1, y2);
+        x = clip_x(x);
+        y1 = clip_y(y1);
+        y2 = clip_y(y2);
+
+        for (int y = y1; y <= y2; ++y) {
+            tiles[y][x] = fill;
+        }
+    }
+
+    static void draw_line(tile_grid &tiles, int x1, int y1, int x2, int y2, int nsegments, uint8_t fill)
+    {
+        int diffx = x2 - x1, diffy = y2 - y1;
+        if (diffx < 0)
+            diffx = -diffx;
+        if (diffy < 0)
+            diffy = -diffy;
+
+        if (diffx < diffy) {
+            std::vector<int> yJumpPositions;
+            std::vector<int> xPositions;
+            for (int i = 0; i < nsegments; ++i) {
+                float t = (float)i / (nsegments-1);
+                xPositions.push_back((1-t) * x1 + t * x2);
+            }
+            for (int i = 0; i < nsegments+1; ++i) {
+                float t = (float)i / (nsegments);
+                yJumpPositions.push_back((1-t) * y1 + t * y2);
+            }
+            int yJump = 0;
+            for (int i = 0; i < nsegments; ++i)
+            {
+                draw_vline(tiles, xPositions[yJump], yJumpPositions[yJump], yJumpPositions[yJump+1], fill);
+                if (i != nsegments - 1)
+                    draw_hline(tiles, xPositions[yJump], xPositions[yJump+1], yJumpPositions[yJump+1], fill);
+                ++yJump;
+            }
+
+        } else {
+            std::vector<int> xJumpPositions;
+            std::vector<int> yPositions;
+            for (int i = 0; i < nsegments; ++i) {
+                float t = (float)i / (nsegments-1);
+                yPositions.push_back((1-t) * y1 + t * y2);
+            }
+            for (int i = 0; i < nsegments+1; ++i) {
+                float t = (float)i / (nsegments);
+                xJumpPositions.push_back((1-t) * x1 + t * x2);
+            }
+            int xJump = 0;
+            for (int i = 0; i < nsegments; ++i)
+            {
+                draw_hline(tiles, xJumpPositions[xJump], xJumpPositions[xJump+1], yPositions[xJump], fill);
+                if (i != nsegments - 1)
+                    draw_vline(tiles, xJumpPositions[xJump+1], yPositions[xJump], yPositions[xJump+1], fill);
+                ++xJump;
+            }
+        }
+    }
+}
+
+// Compares the drawing functions of dungeon/raster.hpp with the original ones, on the original 64x48 map, and shows how the new ones do on big shapes.
+// Also counts the heap allocations every call makes.
+static void bench_raster()
+{
+    std::minstd_rand random{1};
+    reference::tile_grid grid{};
+    tilemap map{64, 48};
+    std::vector<flood_span> stack;
+
+    // Make sure that both draw the same staircases before timing them
+    for (int i = 0; i < 1000; ++i) {
+        int x1 = random() % 64, y1 = random() % 48, x2 = random() % 64, y2 = random() % 48, segments = 2 + random() % 6;
+        reference::draw_line(grid, x1, y1, x2, y2, segments, 1 + i % 255);
+        draw_staircase(map, x1, y1, x2, y2, segments, 1 + i % 255);
+    }
+    for (int y = 0; y < 48; ++y)
+        for (int x = 0; x < 64; ++x)
+            if (grid[y][x] != map.at(x, y))
+                throw std::logic_error("draw_staircase disagrees with the original draw_line");
+
+    // Times a call, and counts its allocations
+    auto measure = [](std::string_view what, uint64_t iterations, const auto &func)
+    {
+        uint64_t allocationsBefore = allocationCount;
+        double ns = time_per_run(iterations, func);
+        report(what, ns);
+        report("  heap allocations per call", (double)(allocationCount - allocationsBefore) / iterations, "");
+    };
+
+    std::cout << "raster: the original 64x48 map against dungeon/raster.hpp (per call)" << std::endl;
+    uint8_t tile = 1;
+    measure("original draw_rect, 11x11", 1'000'000, [&]() { reference::draw_rect(grid, 40, 30, 50, 40, ++tile); });
+    measure("fill_rect, 11x11", 1'000'000, [&]() { fill_rect(map, 40, 30, 50, 40, ++tile | 1); });
+    measure("original draw_hline, 64 tiles", 1'000'000, [&]() { reference::draw_hline(grid, 0, 63, 20, ++tile); });
+    measure("draw_hline, 64 tiles", 1'000'000, [&]() { draw_hline(map, 0, 63, 20, ++tile | 1); });
+    measure("original draw_vline, 48 tiles", 1'000'000, [&]() { reference::draw_vline(grid, 20, 0, 47, ++tile); });
+    measure("draw_vline, 48 tiles", 1'000'000, [&]() { draw_vline(map, 20, 0, 47, ++tile | 1); });
+    measure("original draw_line, 4 segments", 1'000'000, [&]() { reference::draw_line(grid, 20, 40, 10, 10, 4, ++tile); });
+    measure("draw_staircase, 4 segments", 1'000'000, [&]() { draw_staircase(map, 20, 40, 10, 10, 4, ++tile | 1); });
+
+    std::cout << "raster: big shapes on a 4096x4096 map (per call)" << std::endl;
+    tilemap big{4096, 4096};
+    measure("fill_rect, 1000x1000", 200, [&]() { fill_rect(big, 100, 100, 1099, 1099, ++tile | 1); });
+    measure("set() on every tile, 1000x1000", 20, [&]()
+    {
+        uint8_t t = ++tile | 1;
+        for (int y = 100; y < 1100; ++y)
+            for (int x = 100; x < 1100; ++x)
+                big.set(x, y, t);
+    });
+    measure("draw_line, 3000 tiles long", 10'000, [&]() { draw_line(big, 10, 20, 3010, 1500, ++tile | 1); });
+    measure("fill_circle, radius 500", 200, [&]() { fill_circle(big, 2000, 2000, 500, ++tile | 1); });
+    // The same rectangle is filled over and over, switching between two kinds of tiles, so that every fill has the whole thing to do
+    fill_rect(big, 3000, 3000, 3511, 3511, 1);
+    measure("flood_fill, 512x512", 50, [&]() { sink = flood_fill(big, 3200, 3200, big.at(3200, 3200) == 1 ? 2 : 1, stack); });
+}
+
+
+// Checks that a path only takes allowed steps (no walls, no cutting corners), and gives its cost
+static uint32_t check_path(const tilemap &tiles, const std::vector<tile_pos> &path, tile_pos from, tile_pos to)
+{
+    auto free = [&](int x, int y) { return tiles.in_bounds(x, y) && tiles.at(x, y) != TILE_ROCK; };
+    if (path.empty() || path.front() != from || path.back() != to)
+        throw std::logic_error("a path doesn't go from the start to the goal");
+    uint32_t cost = 0;
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        const int dx = path[i].x - path[i - 1].x, dy = path[i].y - path[i - 1].y;
+        if (std::abs(dx) > 1 || std::abs(dy) > 1 || (dx == 0 && dy == 0) || !free(path[i].x, path[i].y)
+            || (dx != 0 && dy != 0 && (!free(path[i - 1].x + dx, path[i - 1].y) || !free(path[i - 1].x, path[i - 1].y + dy))))
+            throw std::logic_error("a path takes a step that isn't allowed");
+        cost += dx != 0 && dy != 0 ? 14 : 10;
+    }
+    return cost;
+}
+
+// Pathfinding on a generated dungeon: A* against jump point search (which have to find equally short paths), flow fields, and a frame of the
+// pathfinder with hundreds of agents
+static void bench_paths()
+{
+    const int size = 512;
+    tilemap tiles{size, size};
+    room_graph graph{size / 16, size / 16};
+    generate_dungeon(tiles, graph, {});
+    std::vector<tile_pos> floor;
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x)
+            if (tiles.at(x, y) != TILE_ROCK)
+                floor.push_back({ x, y });
+
+    std::minstd_rand random{1};
+    auto anywhere = [&]() { return floor[random() % floor.size()]; };
+    walkable_grid grid{tiles};
+    path_search search{grid};
+    std::vector<tile_pos> path;
+    auto find = [&](tile_pos from, tile_pos to, path_method method)
+    {
+        search.start(from, to, method);
+        search.run();
+        search.path(path);
+        return search.found();
+    };
+
+    // Both have to agree on how long the shortest path is
+    for (int i = 0; i < 2000; ++i) {
+        tile_pos from = anywhere(), to = anywhere();
+        bool found = find(from, to, PATH_A_STAR);
+        uint32_t cost = search.cost();
+        if (found)
+            check_path(tiles, path, from, to);
+        if (find(from, to, PATH_JUMP_POINT) != found || (found && (search.cost() != cost || check_path(tiles, path, from, to) != cost)))
+            throw std::logic_error("jump point search found a different path than A*");
+    }
+    // Stopping a search as often as it can be stopped (in the middle of its jumps too), and going on with it, has to find the same path
+    for (int i = 0; i < 200; ++i) {
+        tile_pos from = anywhere(), to = anywhere();
+        bool found = find(from, to, PATH_JUMP_POINT);
+        uint32_t cost = search.cost();
+        search.start(from, to, PATH_JUMP_POINT);
+        while (!search.run(std::chrono::steady_clock::now()))
+            ;
+        if (search.found() != found || search.cost() != cost)
+            throw std::logic_error("a search that was stopped part way found a different path");
+    }
+
+    std::cout << "paths: " << size << "x" << size << " dungeon, " << floor.size() << " free tiles" << std::endl;
+    std::vector<std::pair<tile_pos, tile_pos>> queries;
+    for (int i = 0; i < 200; ++i)
+        queries.push_back({ anywhere(), anywhere() });
+    std::size_t next = 0;
+    uint64_t allocationsBefore = allocationCount;
+    report("A*, random start and goal", time_per_run(2000, [&]()
+    {
+        auto [from, to] = queries[next++ % queries.size()];
+        sink = find(from, to, PATH_A_STAR);
+    }));
+    report("jump point search, random start and goal", time_per_run(2000, [&]()
+    {
+        auto [from, to] = queries[next++ % queries.size()];
+        sink = find(from, to, PATH_JUMP_POINT);
+    }));
+    report("  heap allocations per search (after warming up)", (double)(allocationCount - allocationsBefore) / 4000, "");
+
+    flow_field field{grid};
+    const tile_pos goal = anywhere();
+    report("flow field over the whole map", time_per_run(20, [&]()
+    {
+        field.start(goal);
+        field.run();
+    }));
+    flow_field stopped{grid};
+    stopped.start(goal);
+    while (!stopped.run(std::chrono::steady_clock::now()))
+        ;
+    for (tile_pos tile : floor)
+        if (stopped.cost(tile.x, tile.y) != field.cost(tile.x, tile.y))
+            throw std::logic_error("a flow field that was stopped part way has different costs");
+
+    // Hundreds of agents heading to the same place, every one of them taking a step a frame
+    const int agentCount = 500;
+    std::vector<tile_pos> agents;
+    for (int i = 0; i < agentCount; ++i)
+        agents.push_back(anywhere());
+    std::vector<tile_pos> walking = agents;
+    report("500 agents stepping along a flow field", time_per_run(10'000, [&]()
+    {
+        for (tile_pos &agent : walking)
+            agent = field.next_step(agent.x, agent.y);
+    }), "ns/frame");
+
+    // The same agents going through the pathfinder: first all of them asking for their own path at once, worked out with 1 ms per frame...
+    pathfinder finder{tiles};
+    std::vector<tile_pos> goals;
+    for (int i = 0; i < agentCount; ++i)
+        goals.push_back(anywhere());
+    auto askAll = [&]()
+    {
+        int pending = 0;
+        for (int i = 0; i < agentCount; ++i) {
+            path_status status;
+            sink = finder.path(agents[i], goals[i], status).size();
+            pending += status == PATH_PENDING;
+        }
+        return pending;
+    };
+    // The OS stalls the thread now and then, which the slowest frame catches as well, so the 99th percentile is what tells how well the budget is kept.
+    // It's done a few times over to have enough frames for that
+    const int rounds = 5;
+    std::vector<double> updates;
+    for (int round = 0; round < rounds; ++round) {
+        finder.mark_all_dirty();
+        for (askAll(); askAll() > 0;)
+            updates.push_back(time_per_run(1, [&]() { finder.update(std::chrono::microseconds{1000}); }));
+    }
+    std::sort(updates.begin(), updates.end());
+    report("500 new paths, with a 1 ms budget per frame", (double)updates.size() / rounds, "frames");
+    report("  update() at the 99th percentile", updates[updates.size() * 99 / 100] / 1000, "us");
+    report("  slowest update()", updates.back() / 1000, "us");
+    // ...then asking for them every frame, with all of them cached
+    report("500 cached paths, asked for every frame", time_per_run(1000, [&]()
+    {
+        askAll();
+        finder.update(std::chrono::microseconds{1000});
+    }), "ns/frame");
+    report("500 agents asking for the flow field every frame", time_per_run(1000, [&]()
+    {
+        const flow_field &shared = finder.field(goal);
+        for (tile_pos &agent : walking)
+            agent = shared.next_step(agent.x, agent.y);
+        finder.update(std::chrono::microseconds{1000});
+    }), "ns/frame");
+
+    // Changing a tile only throws out the paths that looked at it
+    const tile_pos changed = anywhere();
+    finder.mark_dirty(changed.x, changed.y, changed.x, changed.y);
+    report("paths still cached after changing a tile", finder.cached_paths(), "");
+}
+
+
+// What can be seen from a tile, by casting a ray (Bresenham's line) to every tile at the edge of the view, and stopping each one at the first wall.
+// That's the straightforward way of doing it, kept here to compare against
+namespace reference
+{
+    static std::size_t raycast_view(const tilemap &tiles, int viewerX, int viewerY, int radius, std::vector<uint8_t> &visible)
+    {
+        // Only the square around the viewer has to be cleared
+        for (int y = std::max(viewerY - radius, 0); y <= std::min(viewerY + radius, tiles.height() - 1); ++y)
+            for (int x = std::max(viewerX - radius, 0); x <= std::min(viewerX + radius, tiles.width() - 1); ++x)
+                visible[y * tiles.width() + x] = 0;
+        std::size_t count = 0;
+        auto cast = [&](int targetX, int targetY)
+        {
+            int x = viewerX, y = viewerY;
+            const int dx = std::abs(targetX - x), dy = -std::abs(targetY - y);
+            const int stepX = x < targetX ? 1 : -1, stepY = y < targetY ? 1 : -1;
+            int error = dx + dy;
+            while (tiles.in_bounds(x, y) && (x - viewerX) * (x - viewerX) + (y - viewerY) * (y - viewerY) <= radius * radius) {
+                uint8_t &seen = visible[y * tiles.width() + x];
+                count += !seen;
+                seen = 1;
+                if ((tiles.at(x, y) == TILE_ROCK && (x != viewerX || y != viewerY)) || (x == targetX && y == targetY))
+                    break;
+                int doubled = 2 * error;
+                if (doubled >= dy) {
+                    error += dy;
+                    x += stepX;
+                }
+                if (doubled <= dx) {
+                    error += dx;
+                    y += stepY;
+                }
+            }
+        };
+        for (int i = -radius; i <= radius; ++i) {
+            cast(viewerX + i, viewerY - radius);
+            cast(viewerX + i, viewerY + radius);
+            cast(viewerX - radius, viewerY + i);
+            cast(viewerX + radius, viewerY + i);
+        }
+        return count;
+    }
+}
+
+// Field of view at growing radii, with shadowcasting against casting rays, in a dungeon (where the walls keep the view small) and in an open cave
+// (where everything in range can be seen)
+static void bench_fov()
+{
+    // Everything within the radius of an open map has to be visible
+    {
+        tilemap open{512, 512};
+        fill_rect(open, 0, 0, 511, 511, TILE_ROOM);
+        field_of_view view{open};
+        const int radius = 200;
+        view.set_viewer(256, 256, radius);
+        int x1, y1, x2, y2;
+        view.update(x1, y1, x2, y2);
+        std::size_t expected = 0;
+        for (int dy = -radius; dy <= radius; ++dy)
+            for (int dx = -radius; dx <= radius; ++dx)
+                expected += dx * dx + dy * dy <= radius * radius;
+        if (view.visible_count() != expected)
+            throw std::logic_error("shadowcasting doesn't see everything on an open map");
+    }
+
+    const int size = 2048;
+    tilemap dungeon{size, size}, cave{size, size};
+    room_graph graph{size / 16, size / 16};
+    generate_dungeon(dungeon, graph, {});
+    fill_rect(cave, 0, 0, size - 1, size - 1, TILE_ROOM);
+    // A few pillars, so that it isn't completely empty
+    for (int y = 8; y < size; y += 16)
+        for (int x = 8; x < size; x += 16)
+            cave.set(x, y, TILE_ROCK);
+    std::vector<uint8_t> seen((std::size_t)size * size);
+
+    const room &middle = graph.get(graph.rooms().size() / 2);
+    const int dungeonX = (middle.mapX1 + middle.mapX2) / 2, dungeonY = (middle.mapY1 + middle.mapY2) / 2;
+    const std::tuple<const char*, const tilemap*, int, int> maps[] = {
+        { "dungeon", &dungeon, dungeonX, dungeonY },
+        { "cave", &cave, size / 2 + 3, size / 2 + 5 },
+    };
+    for (const auto &[name, tiles, viewerX, viewerY] : maps) {
+        std::cout << "fov: " << name << ", " << size << "x" << size << std::endl;
+        field_of_view view{*tiles};
+        int x1, y1, x2, y2;
+        for (int radius : { 8, 32, 128, 512 }) {
+            const uint64_t runs = std::max(2, 200'000 / (radius * radius));
+            std::string label = "radius " + std::to_string(radius);
+            report(label + ", casting rays", time_per_run(runs, [&]() { sink = reference::raycast_view(*tiles, viewerX, viewerY, radius, seen); }));
+            int flip = 0;
+            report(label + ", shadowcasting", time_per_run(runs, [&]()
+            {
+                // The radius goes back and forth by one, so that there's something to work out every time
+                view.set_viewer(viewerX, viewerY, radius + (flip ^= 1));
+                sink = view.update(x1, y1, x2, y2);
+            }));
+            view.set_viewer(viewerX, viewerY, radius);
+            view.update(x1, y1, x2, y2);
+            report("  tiles visible", view.visible_count(), "");
+        }
+        report("update() with nothing changed", time_per_run(1'000'000, [&]() { sink = view.update(x1, y1, x2, y2); }));
+        report("a tile changed out of range", time_per_run(1'000'000, [&]()
+        {
+            view.mark_dirty(0, 0, 0, 0);
+            sink = view.update(x1, y1, x2, y2);
+        }));
+    }
+}
+
+
+// The list of all the benchmarks
+struct benchmark
+{
+    std::string_view name;
+    void (*run)();
+};
+static const benchmark benchmarks[] = {
+    { "aabb", bench_aabb },
+    { "alloc", bench_alloc },
+    { "sdlcall", bench_sdlcall },
+    { "render", bench_render },
+    { "tilemap", bench_tilemap },
+    { "chunks", bench_chunks },
+    { "rooms", bench_rooms },
+    { "components", bench_components },
+    { "dungeon", bench_dungeon },
+    { "raster", bench_raster },
+    { "paths", bench_paths },
+    { "fov", bench_fov },
+};
+
+int run_benchmark(std::string_view name)
+{
+    bool found = false;
+    for (const benchmark &bench : benchmarks) {
+        if (name == "all" || name == bench.name) {
+            bench.run();
+            found = true;
+        }
+    }
+    if (!found) {
+        std::cout << "There's no benchmark called \"" << name << "\". The benchmarks are:";
+        for (const benchmark &bench : benchmarks)
+            std::cout << " " << bench.name;
+        std::cout << std::endl;
+        return 1;
+    }
+    return 0;
+}
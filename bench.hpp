@@ -0,0 +1,16 @@
+#ifndef GAMES_BENCH_HPP
+#define GAMES_BENCH_HPP
+
+#include <string_view>  // std::string_view
+#include <cstdint>      // uint64_t
+
+// Microbenchmarks for the performance-sensitive parts of the game. They're their own program, built with `make bench`, and run with `bench <name>` (or
+// `bench all`). Each one prints its own results. SDL doesn't need to be initialized for them.
+
+// Runs the benchmark with the given name. Returns the exit code for main -- 0 on success, 1 if there's no such benchmark.
+int run_benchmark(std::string_view name);
+
+// How many heap allocations the current thread has made so far. It's counted by the operator new that bench_main.cpp replaces
+extern thread_local uint64_t allocationCount;
+
+#endif  // GAMES_BENCH_HPP
@@ -0,0 +1,35 @@
+#include <cstdint>      // uint64_t
+#include <cstdlib>      // std::malloc, std::free
+#include <new>          // std::bad_alloc
+#include <string_view>  // std::string_view
+
+#include "bench.hpp"
+
+// The benchmarks are a program of their own (see the Makefile), so that this can be in here: the global operator new is replaced, so that the amount of
+// heap allocations can be counted. Every thread has its own counter, so that this doesn't slow down threads that allocate at the same time. The rest of
+// the operators (arrays, nothrow, aligned...) are implemented by the standard library in terms of these two. The game itself keeps the standard ones.
+thread_local uint64_t allocationCount = 0;
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// Invoked as `bench [name]`, running every benchmark if there's no name
+int main(int argc, char **argv)
+{
+    return run_benchmark(argc > 1 ? argv[1] : "all");
+}
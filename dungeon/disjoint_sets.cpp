@@ -0,0 +1,62 @@
+#include "disjoint_sets.hpp"
+
+#include <utility>  // std::swap
+
+uint32_t disjoint_sets::add()
+{
+    uint32_t thing = m_parent.size();
+    m_parent.push_back(thing);
+    m_size.push_back(1);
+    ++m_groups;
+    return thing;
+}
+
+uint32_t disjoint_sets::find(uint32_t thing) const
+{
+    // Every thing on the way is made to point to its grandparent, which halves the path for the next lookup
+    while (m_parent[thing] != thing) {
+        m_parent[thing] = m_parent[m_parent[thing]];
+        thing = m_parent[thing];
+    }
+    return thing;
+}
+
+bool disjoint_sets::unite(uint32_t thing1, uint32_t thing2)
+{
+    uint32_t root1 = find(thing1), root2 = find(thing2);
+    if (root1 == root2)
+        return false;
+    if (m_size[root1] < m_size[root2])
+        std::swap(root1, root2);
+    m_parent[root2] = root1;
+    m_size[root1] += m_size[root2];
+    --m_groups;
+    return true;
+}
+
+bool disjoint_sets::connected(uint32_t thing1, uint32_t thing2) const
+{
+    return find(thing1) == find(thing2);
+}
+
+std::size_t disjoint_sets::group_size(uint32_t thing) const
+{
+    return m_size[find(thing)];
+}
+
+std::size_t disjoint_sets::groups() const
+{
+    return m_groups;
+}
+
+std::size_t disjoint_sets::size() const
+{
+    return m_parent.size();
+}
+
+void disjoint_sets::clear()
+{
+    m_parent.clear();
+    m_size.clear();
+    m_groups = 0;
+}
@@ -0,0 +1,28 @@
+#ifndef GAMES_DUNGEON_DISJOINT_SETS_HPP
+#define GAMES_DUNGEON_DISJOINT_SETS_HPP
+
+#include <vector>   // std::vector
+#include <cstdint>  // uint32_t
+#include <cstddef>  // std::size_t
+
+// Keeps track of which things (numbered from 0) are connected to each other, as things get connected -- a union-find. Every group of connected things
+// has one of them as its representative, and the others point towards it. Looking it up flattens the path on the way (path halving), and joining two
+// groups hangs the smaller one under the bigger one, which keeps the paths so short that every operation is practically O(1).
+class disjoint_sets final
+{
+    mutable std::vector<uint32_t> m_parent;  // What every thing points towards (itself, for representatives). Lookups shorten the paths, hence the mutable
+    std::vector<uint32_t> m_size;  // How many things are in a group (only kept up to date for representatives)
+    std::size_t m_groups = 0;
+
+public:
+    uint32_t add();  // Adds a new thing, in a group of its own. Gives its number
+    uint32_t find(uint32_t thing) const;  // Gives the representative of the group of a thing
+    bool unite(uint32_t thing1, uint32_t thing2);  // Puts two things (and everything connected to them) in the same group. Returns false if they already were
+    bool connected(uint32_t thing1, uint32_t thing2) const;
+    std::size_t group_size(uint32_t thing) const;  // How many things are in the group of a thing
+    std::size_t groups() const;  // How many groups there are
+    std::size_t size() const;  // How many things there are
+    void clear();  // Forgets every thing (but keeps the memory)
+};
+
+#endif  // GAMES_DUNGEON_DISJOINT_SETS_HPP
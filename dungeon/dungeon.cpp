@@ -0,0 +1,95 @@
+#include "dungeon.hpp"
+#include "../utils.hpp"
+
+#include <algorithm>  // std::min
+#include <cmath>      // std::ceil
+#include <chrono>     // std::chrono::microseconds
+#include <cstdint>    // int64_t
+
+dungeon_crawler_scene::dungeon_crawler_scene(scenes &scenes, SDL_Renderer *renderer)
+    : scene{scenes, renderer}, m_tiles{MAP_WIDTH, MAP_HEIGHT}, m_rooms{MAP_WIDTH / m_settings.cellSize, MAP_HEIGHT / m_settings.cellSize},
+    m_tileRenderer{renderer, m_tiles.width(), m_tiles.height()}, m_pathfinder{m_tiles}, m_view{m_tiles}
+{
+    // Rock is dark gray, rooms are white, and corridors are light gray
+    m_tileRenderer.set_color(TILE_ROCK, { 30, 30, 30, 255 });
+    m_tileRenderer.set_color(TILE_ROOM, { 255, 255, 255, 255 });
+    m_tileRenderer.set_color(TILE_CORRIDOR, { 170, 170, 170, 255 });
+}
+
+void dungeon_crawler_scene::generate()
+{
+    generate_dungeon(m_tiles, m_rooms, m_settings);
+    m_tileRenderer.mark_all_dirty();
+    m_pathfinder.mark_all_dirty();
+    m_view.mark_all_dirty();
+
+    // The player starts off in the middle of the first room
+    if (!m_rooms.rooms().empty()) {
+        const room &first = m_rooms.get(0);
+        m_player = { (first.mapX1 + first.mapX2) / 2, (first.mapY1 + first.mapY2) / 2 };
+    }
+    m_view.set_viewer(m_player.x, m_player.y, VIEW_RADIUS);
+}
+
+void dungeon_crawler_scene::move_player(int dx, int dy)
+{
+    const int x = m_player.x + dx, y = m_player.y + dy;
+    if (!m_tiles.in_bounds(x, y) || m_tiles.at(x, y) == TILE_ROCK)
+        return;
+    m_player = { x, y };
+    m_view.set_viewer(x, y, VIEW_RADIUS);
+}
+
+void dungeon_crawler_scene::activate()
+{
+    generate();
+}
+
+void dungeon_crawler_scene::draw(render_queue &queue, float) const
+{
+    queue.clear({ 0, 0, 0, 255 });
+
+    // Send whatever changed since the last frame to the texture. The tiles that the player can't see are left out
+    m_tileRenderer.upload([this](int x, int y) { return m_tiles.at(x, y); }, [this](int x, int y) { return m_view.visible(x, y); });
+
+    // The map is stretched as much as it fits in the window (keeping the tiles square), and put in the middle
+    const auto [windowW, windowH] = m_scenes.window_dimensions();
+    float scale = std::min((float)windowW / m_tiles.width(), (float)windowH / m_tiles.height());
+    float w = m_tiles.width() * scale, h = m_tiles.height() * scale;
+    m_tileRenderer.draw(queue, 0, { (windowW - w) / 2, (windowH - h) / 2, w, h });
+
+    // The player is a red tile on top of it
+    const int tileSize = std::ceil(scale);
+    SDL_Rect player = { (int)((windowW - w) / 2 + m_player.x * scale), (int)((windowH - h) / 2 + m_player.y * scale), tileSize, tileSize };
+    queue.fill_rect(1, player, { 220, 40, 40, 255 });
+}
+
+void dungeon_crawler_scene::update(float dt)
+{
+    m_pathfinder.update(std::chrono::microseconds{(int64_t)(dt * PATHFINDING_SHARE * 1'000'000)});
+
+    // What the player sees is only worked out again when they moved (or the map changed), and only the tiles around them are redrawn then
+    int x1, y1, x2, y2;
+    if (m_view.update(x1, y1, x2, y2))
+        m_tileRenderer.mark_dirty(x1, y1, x2, y2);
+}
+
+void dungeon_crawler_scene::on_event(const SDL_Event &event)
+{
+    if (event.type == SDL_KEYDOWN) {
+        if (event.key.keysym.sym == SDLK_ESCAPE) {
+            m_scenes.pop_scene();
+        } else if (event.key.keysym.sym == SDLK_r) {
+            ++m_settings.seed;
+            generate();
+        } else if (event.key.keysym.sym == SDLK_LEFT) {
+            move_player(-1, 0);
+        } else if (event.key.keysym.sym == SDLK_RIGHT) {
+            move_player(1, 0);
+        } else if (event.key.keysym.sym == SDLK_UP) {
+            move_player(0, -1);
+        } else if (event.key.keysym.sym == SDLK_DOWN) {
+            move_player(0, 1);
+        }
+    }
+}
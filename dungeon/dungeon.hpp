@@ -0,0 +1,52 @@
+#ifndef GAMES_DUNGEON_DUNGEON_HPP
+#define GAMES_DUNGEON_DUNGEON_HPP
+
+#include <cstdint>  // uint8_t
+
+#include "../scene.hpp"
+#include "tilemap.hpp"
+#include "room_graph.hpp"
+#include "generator.hpp"
+#include "tile_renderer.hpp"
+#include "pathfinder.hpp"
+#include "field_of_view.hpp"
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+
+// The size of the dungeon map, in tiles
+const int MAP_WIDTH = 256, MAP_HEIGHT = 192;
+// How much of every update the pathfinder gets to work out paths (1 / 10, so 0.83 ms at 120 updates per second). Whatever doesn't fit is carried on with
+// in the next one. It's kept well below the length of an update, as the rest of the update and the drawing have to fit in there too, and the pathfinder
+// can go a few microseconds past its budget
+const double PATHFINDING_SHARE = 0.1;
+const int VIEW_RADIUS = 20;  // How far the player can see, in tiles
+
+// The scene of the dungeon crawler. Left unfinished, I sadly ran out of time -- for now, it only generates a dungeon and shows the part of its map that
+// the player can see. The arrow keys move the player around, and R makes a new dungeon
+class dungeon_crawler_scene final : public scene
+{
+    // What the dungeon is generated with. The seed goes up by one for every new dungeon. It's declared first, as the room graph is sized from it
+    dungeon_settings m_settings;
+    tilemap m_tiles;  // The map itself (see tilemap.hpp)
+    room_graph m_rooms;  // The rooms on the map, and how they're connected (see room_graph.hpp)
+    // Draws the map. Every change to m_tiles has to be marked dirty in it. It's only uploaded when drawing, so that the changes of several updates are
+    // uploaded at once (and drawing is const, hence the mutable)
+    mutable tile_renderer m_tileRenderer;
+    pathfinder m_pathfinder;  // Paths through the map, for whatever walks around in it. Like the renderer, it has to be told about every change to m_tiles
+    field_of_view m_view;  // What the player can see. Only that is drawn, and it also has to be told about every change to m_tiles
+    tile_pos m_player = { 0, 0 };
+
+    void generate();  // Replaces the map with a new dungeon, and puts the player in it
+    void move_player(int dx, int dy);  // Moves the player by a tile, unless there's a wall there
+
+public:
+    dungeon_crawler_scene(scenes &scenes, SDL_Renderer *renderer);
+
+    void activate() override;
+    void draw(render_queue &queue, float alpha) const override;
+    void update(float deltaTime) override;
+    void on_event(const SDL_Event &event) override;
+};
+
+#endif  // GAMES_DUNGEON_DUNGEON_HPP
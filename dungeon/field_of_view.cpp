@@ -0,0 +1,152 @@
+#include "field_of_view.hpp"
+
+#include <algorithm>  // std::fill, std::min, std::max, std::swap
+#include <bit>        // std::popcount
+#include <climits>    // INT_MAX
+#include <cmath>      // std::ceil
+
+field_of_view::field_of_view(const tilemap &tiles)
+    : m_grid{tiles}, m_words{(tiles.width() + 63) / 64}
+{
+    m_visible.assign((std::size_t)m_words * tiles.height(), 0);
+}
+
+void field_of_view::set_viewer(int x, int y, int radius)
+{
+    if (x == m_viewerX && y == m_viewerY && radius == m_radius)
+        return;
+    m_viewerX = x;
+    m_viewerY = y;
+    m_radius = radius;
+    m_stale = true;
+}
+
+void field_of_view::mark_dirty(int x1, int y1, int x2, int y2)
+{
+    m_grid.refresh(x1, y1, x2, y2);
+    if (x1 > x2)
+        std::swap(x1, x2);
+    if (y1 > y2)
+        std::swap(y1, y2);
+    // Only a change within the viewer's reach can change what it sees
+    if (x1 <= m_viewerX + m_radius && x2 >= m_viewerX - m_radius && y1 <= m_viewerY + m_radius && y2 >= m_viewerY - m_radius)
+        m_stale = true;
+}
+
+void field_of_view::mark_all_dirty()
+{
+    m_grid.refresh(0, 0, m_grid.width() - 1, m_grid.height() - 1);
+    m_stale = true;
+}
+
+void field_of_view::cast_light(int row, float start, float end, int xx, int xy, int yx, int yy)
+{
+    if (start < end)
+        return;
+
+    // Every row of the octant is scanned from the edge of the wedge towards its middle. Every tile covers a range of slopes (the angle at which it's
+    // seen, as dx / dy), and it's in view if that range overlaps the one that's still open. A wall closes off its part of the range: the rest of the
+    // row (past the wall) goes on with a narrower range, and the part of the range before the wall is scanned on its own, from the next row on
+    const int radius2 = m_radius * m_radius;
+    float newStart = 0;
+    for (int j = row; j <= m_radius; ++j) {
+        const int dy = -j;
+        bool blocked = false;
+        // The tiles before the open range starts are skipped straight away, rather than one by one -- the scans of the narrow ranges in between
+        // lots of walls would spend most of their time on that otherwise
+        const int first = std::max(-j, (int)std::ceil(start * (dy - 0.5f) - 0.5f) - 1);
+        for (int dx = first; dx <= 0; ++dx) {
+            const float leftSlope = (dx - 0.5f) / (dy + 0.5f), rightSlope = (dx + 0.5f) / (dy - 0.5f);
+            if (start < rightSlope)
+                continue;
+            if (end > leftSlope)
+                break;
+
+            // Anything off the map is treated like a wall, so the scan stops at the edges
+            const int x = m_viewerX + dx * xx + dy * xy, y = m_viewerY + dx * yx + dy * yy;
+            const bool onMap = m_grid.in_bounds(x, y);
+            if (onMap && dx * dx + dy * dy <= radius2)
+                reveal(x, y);
+            const bool wall = !onMap || !m_grid.walkable(m_grid.index(x, y));
+            if (blocked) {
+                if (wall) {
+                    newStart = rightSlope;
+                    continue;
+                }
+                blocked = false;
+                start = newStart;
+            } else if (wall && j < m_radius) {
+                blocked = true;
+                cast_light(j + 1, start, leftSlope, xx, xy, yx, yy);
+                newStart = rightSlope;
+            }
+        }
+        if (blocked)
+            break;
+    }
+}
+
+bool field_of_view::update(int &x1, int &y1, int &x2, int &y2)
+{
+    if (!m_stale)
+        return false;
+    m_stale = false;
+
+    // Only the part that the last view could reach has to be cleared
+    const int oldX1 = m_litX1, oldY1 = m_litY1, oldX2 = m_litX2, oldY2 = m_litY2;
+    if (oldX1 <= oldX2)
+        for (int y = oldY1; y <= oldY2; ++y)
+            std::fill(&m_visible[y * m_words + (oldX1 >> 6)], &m_visible[y * m_words + (oldX2 >> 6)] + 1, 0);
+
+    if (m_radius >= 0 && m_grid.in_bounds(m_viewerX, m_viewerY)) {
+        m_litX1 = std::max(m_viewerX - m_radius, 0);
+        m_litY1 = std::max(m_viewerY - m_radius, 0);
+        m_litX2 = std::min(m_viewerX + m_radius, m_grid.width() - 1);
+        m_litY2 = std::min(m_viewerY + m_radius, m_grid.height() - 1);
+        reveal(m_viewerX, m_viewerY);
+        // The transforms of the 8 octants: the first two numbers turn the octant's coordinates into an x offset, the last two into a y offset
+        static const int octants[8][4] = {
+            { 1, 0, 0, 1 }, { 0, 1, 1, 0 }, { 0, -1, 1, 0 }, { -1, 0, 0, 1 },
+            { -1, 0, 0, -1 }, { 0, -1, -1, 0 }, { 0, 1, -1, 0 }, { 1, 0, 0, -1 },
+        };
+        for (const auto &octant : octants)
+            cast_light(1, 1.0f, 0.0f, octant[0], octant[1], octant[2], octant[3]);
+    } else {
+        m_litX1 = m_litY1 = 0;
+        m_litX2 = m_litY2 = -1;
+    }
+
+    // What changed is somewhere in the old view or the new one
+    x1 = y1 = INT_MAX;
+    x2 = y2 = -1;
+    auto add = [&](int areaX1, int areaY1, int areaX2, int areaY2)
+    {
+        if (areaX1 > areaX2)
+            return;
+        x1 = std::min(x1, areaX1);
+        y1 = std::min(y1, areaY1);
+        x2 = std::max(x2, areaX2);
+        y2 = std::max(y2, areaY2);
+    };
+    add(oldX1, oldY1, oldX2, oldY2);
+    add(m_litX1, m_litY1, m_litX2, m_litY2);
+    return x1 <= x2;
+}
+
+const uint64_t *field_of_view::row(int y) const
+{
+    return &m_visible[y * m_words];
+}
+
+int field_of_view::words_per_row() const
+{
+    return m_words;
+}
+
+std::size_t field_of_view::visible_count() const
+{
+    std::size_t count = 0;
+    for (uint64_t word : m_visible)
+        count += std::popcount(word);
+    return count;
+}
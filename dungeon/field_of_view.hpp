@@ -0,0 +1,56 @@
+#ifndef GAMES_DUNGEON_FIELD_OF_VIEW_HPP
+#define GAMES_DUNGEON_FIELD_OF_VIEW_HPP
+
+#include <vector>   // std::vector
+#include <cstdint>  // uint64_t
+#include <cstddef>  // std::size_t
+
+#include "tilemap.hpp"
+#include "pathfinder.hpp"
+
+// What can be seen from a tile of the map, up to some distance, with recursive shadowcasting: the area around the viewer is split into 8 wedges
+// (octants), and each one is scanned a row at a time going outwards, keeping track of the range of angles that isn't hidden behind a wall yet. Every
+// wall found narrows the range (or splits it in two, and the part on the other side is scanned on its own), so every tile in view is looked at once,
+// and the ones behind walls aren't looked at at all -- unlike casting a ray to every tile at the edge of the view, which goes over the tiles close to the
+// viewer again and again.
+//
+// The tiles that can be walked on can be seen through (see walkable_grid), and the walls around them can be seen too. What's visible is kept as a bitset
+// per row of the map, one bit per tile, and only worked out again once the viewer moves, or a tile in view range changes (which, like in the
+// pathfinder, has to be marked dirty).
+class field_of_view final
+{
+    walkable_grid m_grid;  // Which tiles can be seen through
+    const int m_words;  // How many words every row of the bitset takes up
+    std::vector<uint64_t> m_visible;  // Row by row
+
+    int m_viewerX = 0, m_viewerY = 0, m_radius = -1;
+    bool m_stale = true;  // Whether it has to be worked out again
+    int m_litX1 = 0, m_litY1 = 0, m_litX2 = -1, m_litY2 = -1;  // The part of the map (inclusive) that the last view could reach. Empty when x1 > x2
+
+    void reveal(int x, int y) { m_visible[y * m_words + (x >> 6)] |= (uint64_t)1 << (x & 63); }
+    // Scans an octant from the given row outwards, between two slopes (start > end). The transform (xx, xy, yx, yy) turns the octant's own
+    // coordinates (across the row, and along the octant) into offsets on the map
+    void cast_light(int row, float start, float end, int xx, int xy, int yx, int yy);
+
+public:
+    explicit field_of_view(const tilemap &tiles);  // The map has to stay alive, and the same size, for as long as this is used. Nothing is visible yet
+    field_of_view(const field_of_view &) = delete;
+
+    void set_viewer(int x, int y, int radius);  // Moves the viewer (which has to be on the map). The view reaches up to radius tiles away
+    void mark_dirty(int x1, int y1, int x2, int y2);  // Tells that the tiles in between the two corners (inclusive) changed
+    void mark_all_dirty();
+
+    // Works out what's visible again, if anything changed since the last time. Returns whether it did, and if so, sets the corners of the area where tiles
+    // could have been revealed or hidden (for marking it dirty in a tile_renderer, say)
+    bool update(int &x1, int &y1, int &x2, int &y2);
+
+    bool visible(int x, int y) const  // Whether a tile (which has to be on the map) can be seen
+    {
+        return m_visible[y * m_words + (x >> 6)] >> (x & 63) & 1;
+    }
+    const uint64_t *row(int y) const;  // The bits of a whole row, the tile at x being bit x % 64 of word x / 64
+    int words_per_row() const;
+    std::size_t visible_count() const;  // How many tiles can be seen
+};
+
+#endif  // GAMES_DUNGEON_FIELD_OF_VIEW_HPP
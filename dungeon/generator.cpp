@@ -0,0 +1,153 @@
+#include "generator.hpp"
+#include "raster.hpp"
+
+#include <vector>     // std::vector
+#include <random>     // std::minstd_rand
+#include <algorithm>  // std::sort, std::min, std::max, std::swap
+#include <atomic>     // std::atomic
+#include <thread>     // std::thread
+#include <tuple>      // std::tie
+#include <stdexcept>  // std::invalid_argument
+
+// Mixes a few numbers into one well spread out number (splitmix64). Every row of cells and every corridor gets its random numbers from this, rather than
+// from one shared generator, so that they don't depend on the order that things are done in
+static uint32_t mix(uint32_t seed, uint32_t a, uint32_t b)
+{
+    uint64_t x = ((uint64_t)seed << 32 | a) ^ ((uint64_t)b * 0x9E3779B97F4A7C15ull);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return (uint32_t)(x ^ (x >> 31));
+}
+
+// Runs job(i) for every i from 0 to jobs - 1, spread over `threads` threads. Every thread keeps grabbing the next job that nobody has started yet (just
+// like run_batch, see pong/batch.cpp)
+static void run_parallel(unsigned jobs, unsigned threads, const auto &job)
+{
+    std::atomic<unsigned> nextJob = 0;
+    auto worker = [&]()
+    {
+        for (unsigned i = nextJob++; i < jobs; i = nextJob++)
+            job(i);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < std::min(threads, jobs); ++i)
+        workers.emplace_back(worker);
+    worker();  // The calling thread does its share of work too
+    for (auto &thread : workers)
+        thread.join();
+}
+
+namespace
+{
+    // A room, before it's put into the room graph
+    struct room_plan
+    {
+        int x, y;
+        int mapX1, mapY1, mapX2, mapY2;
+    };
+
+    // A pair of neighboring rooms that could be connected. The corridors are dug in order of their weight, which is random
+    struct corridor_plan
+    {
+        uint32_t weight;
+        room_id room1, room2;
+
+        bool operator<(const corridor_plan &other) const
+        {
+            return std::tie(weight, room1, room2) < std::tie(other.weight, other.room1, other.room2);
+        }
+    };
+
+    // A rectangle of tiles to carve (corners inclusive)
+    struct carving
+    {
+        int x1, y1, x2, y2;
+        dungeon_tile tile;
+    };
+}
+
+void generate_dungeon(tilemap &tiles, room_graph &graph, const dungeon_settings &settings, unsigned threads)
+{
+    const int cellSize = settings.cellSize;
+    if (graph.width() != tiles.width() / cellSize || graph.height() != tiles.height() / cellSize)
+        throw std::invalid_argument("the room graph has to have one cell for every cellSize x cellSize tiles of the map");
+    if (settings.minRoomSize < 1 || settings.minRoomSize > cellSize - 2)
+        throw std::invalid_argument("rooms have to be at least 1 tile, and fit in a cell with a tile of rock around them");
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Plan the rooms, a row of cells at a time. Every row has its own random numbers, so the rows can be done in any order (and on any thread)
+    std::vector<std::vector<room_plan>> roomRows(graph.height());
+    run_parallel(graph.height(), threads, [&](unsigned y)
+    {
+        std::minstd_rand random{mix(settings.seed, 0, y)};
+        const int sizes = cellSize - 2 - settings.minRoomSize + 1;
+        for (int x = 0; x < graph.width(); ++x) {
+            if ((int)(random() % 100) >= settings.roomChance)
+                continue;
+            int w = settings.minRoomSize + random() % sizes, h = settings.minRoomSize + random() % sizes;
+            int mapX = x * cellSize + 1 + random() % (cellSize - 1 - w), mapY = (int)y * cellSize + 1 + random() % (cellSize - 1 - h);
+            roomRows[y].push_back({ x, (int)y, mapX, mapY, mapX + w - 1, mapY + h - 1 });
+        }
+    });
+
+    // Put the rooms into the graph, in order, so that they're numbered the same way every time
+    tiles.clear();
+    graph.clear();
+    std::vector<carving> carvings;
+    for (const std::vector<room_plan> &row : roomRows)
+        for (const room_plan &plan : row) {
+            graph.add_room(plan.x, plan.y, plan.mapX1, plan.mapY1, plan.mapX2, plan.mapY2);
+            carvings.push_back({ plan.mapX1, plan.mapY1, plan.mapX2, plan.mapY2, TILE_ROOM });
+        }
+
+    // Every room could be connected to its neighbors on the right and below (the ones on the left and above will connect to it). Going through those in
+    // a random order, and only digging the ones between rooms that aren't connected yet, connects every room with as few corridors as possible
+    // (Kruskal's algorithm, with random weights). A few of the rest are dug anyway
+    std::vector<corridor_plan> corridors;
+    for (room_id id = 0; id < graph.rooms().size(); ++id)
+        for (direction dir : { DIR_RIGHT, DIR_DOWN }) {
+            room_id other = graph.neighbor(id, dir).room;
+            if (other != NO_ROOM)
+                corridors.push_back({ mix(settings.seed, id + 1, other), id, other });
+        }
+    std::sort(corridors.begin(), corridors.end());
+    for (const corridor_plan &corridor : corridors) {
+        if (graph.connected(corridor.room1, corridor.room2) && (int)((corridor.weight >> 8) % 100) >= settings.loopChance)
+            continue;
+
+        // The corridor goes from the middle of one room to the middle of the other, bending once
+        const room &room1 = graph.get(corridor.room1), &room2 = graph.get(corridor.room2);
+        int x1 = (room1.mapX1 + room1.mapX2) / 2, y1 = (room1.mapY1 + room1.mapY2) / 2;
+        int x2 = (room2.mapX1 + room2.mapX2) / 2, y2 = (room2.mapY1 + room2.mapY2) / 2;
+        graph.connect(corridor.room1, corridor.room2, x1, y1, x2, y2);
+        if (corridor.weight & (1 << 24)) {
+            carvings.push_back({ std::min(x1, x2), y1, std::max(x1, x2), y1, TILE_CORRIDOR });
+            carvings.push_back({ x2, std::min(y1, y2), x2, std::max(y1, y2), TILE_CORRIDOR });
+        } else {
+            carvings.push_back({ x1, std::min(y1, y2), x1, std::max(y1, y2), TILE_CORRIDOR });
+            carvings.push_back({ std::min(x1, x2), y2, std::max(x1, x2), y2, TILE_CORRIDOR });
+        }
+    }
+
+    // Carve it all in, a row of chunks at a time, so that no two threads ever write into the same chunk. The chunks are allocated beforehand (that
+    // can't be done from several threads), and every row of chunks gets the list of carvings that reach into it, in order
+    std::vector<std::vector<uint32_t>> chunkRows((tiles.height() + tilemap::CHUNK_MASK) >> tilemap::CHUNK_SHIFT);
+    for (uint32_t i = 0; i < carvings.size(); ++i) {
+        const carving &c = carvings[i];
+        tiles.reserve(c.x1, c.y1, c.x2, c.y2);
+        for (int row = c.y1 >> tilemap::CHUNK_SHIFT; row <= c.y2 >> tilemap::CHUNK_SHIFT; ++row)
+            chunkRows[row].push_back(i);
+    }
+    run_parallel(chunkRows.size(), threads, [&](unsigned row)
+    {
+        // The corridors go in first, so that the rooms they pass through are carved over them
+        const int top = row << tilemap::CHUNK_SHIFT, bottom = top + tilemap::CHUNK_SIZE - 1;
+        for (dungeon_tile tile : { TILE_CORRIDOR, TILE_ROOM })
+            for (uint32_t i : chunkRows[row]) {
+                const carving &c = carvings[i];
+                if (c.tile == tile)
+                    fill_rect(tiles, c.x1, std::max(c.y1, top), c.x2, std::min(c.y2, bottom), c.tile);
+            }
+    });
+}
@@ -0,0 +1,36 @@
+#ifndef GAMES_DUNGEON_GENERATOR_HPP
+#define GAMES_DUNGEON_GENERATOR_HPP
+
+#include <cstdint>  // uint8_t, uint32_t
+
+#include "tilemap.hpp"
+#include "room_graph.hpp"
+
+// The kinds of tiles that the generator carves
+enum dungeon_tile : uint8_t
+{
+    TILE_ROCK = 0,  // Solid, what the whole map starts off as
+    TILE_ROOM = 1,
+    TILE_CORRIDOR = 2,
+};
+
+// What a dungeon should look like
+struct dungeon_settings
+{
+    uint32_t seed = 1;
+    int cellSize = 16;  // The size of a cell of the room graph, in tiles. Every room fits in a single cell, with a tile of rock around it
+    int minRoomSize = 4;  // The smallest a room can be on either side, in tiles (the biggest is cellSize - 2)
+    int roomChance = 60;  // How likely a cell is to have a room in it, in percent
+    int loopChance = 15;  // How likely a corridor that isn't needed to connect the rooms is to be dug anyway, in percent (so that there are loops)
+};
+
+// Fills the tile map and the room graph with a new dungeon (whatever was in them is cleared). The room graph has to be the size of the tile map, in cells.
+// Every room is connected to every other one, through corridors between neighboring rooms -- a random spanning tree of the neighbors, plus a few
+// extra corridors for loops.
+//
+// The work is spread over `threads` threads (0 means one per CPU core). Every row of cells gets its own random numbers (worked out from the seed and
+// the row), and the tiles are carved a row of chunks per thread at a time, so the same seed always gives the exact same dungeon, no matter how many
+// threads make it. Throws std::invalid_argument if the sizes don't match, or the settings don't make sense.
+void generate_dungeon(tilemap &tiles, room_graph &graph, const dungeon_settings &settings, unsigned threads = 0);
+
+#endif  // GAMES_DUNGEON_GENERATOR_HPP
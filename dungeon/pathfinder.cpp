@@ -0,0 +1,641 @@
+#include "pathfinder.hpp"
+#include "generator.hpp"
+
+#include <algorithm>  // std::push_heap, std::pop_heap, std::fill, std::reverse, std::nth_element, std::min, std::max, std::swap
+#include <cstdlib>    // std::abs
+
+// The clock is only looked at once every this many tiles were looked at, as asking for the time isn't free either. It's about a microsecond of work
+static const unsigned TILES_PER_CLOCK_CHECK = 128;
+// The arrays the size of the map are reset this many entries at a time, with a look at the clock in between
+static const std::size_t FILL_PIECE = 4096;
+
+static int sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+// Sets the entries of an array from `from` on to a value, a piece at a time, until it's done (true) or past the deadline (false, and then from is where
+// it got to). At least one piece is done every time
+static bool fill_until(std::vector<uint32_t> &values, std::size_t &from, uint32_t value, std::chrono::steady_clock::time_point deadline)
+{
+    while (from < values.size()) {
+        const std::size_t end = std::min(from + FILL_PIECE, values.size());
+        std::fill(values.begin() + from, values.begin() + end, value);
+        from = end;
+        if (from < values.size() && std::chrono::steady_clock::now() >= deadline)
+            return false;
+    }
+    return true;
+}
+
+bool explored_area::touches(int changedX1, int changedY1, int changedX2, int changedY2) const
+{
+    if (changedX1 > changedX2)
+        std::swap(changedX1, changedX2);
+    if (changedY1 > changedY2)
+        std::swap(changedY1, changedY2);
+    return changedX1 <= x2 + 1 && changedX2 >= x1 - 1 && changedY1 <= y2 + 1 && changedY2 >= y1 - 1;
+}
+
+
+walkable_grid::walkable_grid(const tilemap &tiles)
+    : m_tiles{tiles}, m_width{tiles.width()}, m_height{tiles.height()}, m_stride{tiles.width() + 2}
+{
+    m_walkable.assign((std::size_t)m_stride * (m_height + 2), 0);
+    refresh(0, 0, m_width - 1, m_height - 1);
+}
+
+void walkable_grid::refresh(int x1, int y1, int x2, int y2)
+{
+    if (x1 > x2)
+        std::swap(x1, x2);
+    if (y1 > y2)
+        std::swap(y1, y2);
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, m_width - 1);
+    y2 = std::min(y2, m_height - 1);
+    for (int y = y1; y <= y2; ++y)
+        for (int x = x1; x <= x2; ++x)
+            m_walkable[index(x, y)] = m_tiles.at(x, y) != TILE_ROCK;
+}
+
+int walkable_grid::width() const
+{
+    return m_width;
+}
+
+int walkable_grid::height() const
+{
+    return m_height;
+}
+
+bool walkable_grid::in_bounds(int x, int y) const
+{
+    return x >= 0 && y >= 0 && x < m_width && y < m_height;
+}
+
+
+// Which of the tiles around a tile are walkable, in a 3x3 block with the tile in the middle. Diagonal steps need to know about the straight ones next
+// to them too, so they're all looked up once
+static void neighborhood(const walkable_grid &grid, uint32_t index, bool (&walkable)[3][3])
+{
+    for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx)
+            walkable[dy + 1][dx + 1] = grid.walkable(index + dy * grid.stride() + dx);
+}
+
+// A step from a tile is allowed if the tile it goes to is walkable, and for a diagonal step, both of the tiles it squeezes past are too
+static bool can_step(const bool (&walkable)[3][3], int dx, int dy)
+{
+    return walkable[dy + 1][dx + 1] && (dx == 0 || dy == 0 || (walkable[1][dx + 1] && walkable[dy + 1][1]));
+}
+
+
+path_search::path_search(const walkable_grid &grid)
+    : m_grid{grid}
+{
+    m_cost.resize(grid.size());
+    m_parent.resize(grid.size());
+    m_stamp.assign(grid.size(), 0);
+    m_cleared = m_stamp.size();
+}
+
+bool path_search::out_of_time(std::chrono::steady_clock::time_point deadline)
+{
+    if (m_work < TILES_PER_CLOCK_CHECK)
+        return false;
+    m_work = 0;
+    return std::chrono::steady_clock::now() >= deadline;
+}
+
+uint32_t path_search::heuristic(tile_pos position) const
+{
+    // As many diagonal steps as the shorter distance, and straight ones for the rest
+    const uint32_t dx = std::abs(position.x - m_to.x), dy = std::abs(position.y - m_to.y);
+    return STRAIGHT_COST * std::max(dx, dy) + (DIAGONAL_COST - STRAIGHT_COST) * std::min(dx, dy);
+}
+
+// Out of the tiles in the open list that look just as good, the one furthest along is tried first
+static bool worse(uint32_t f1, uint32_t g1, uint32_t f2, uint32_t g2)
+{
+    return f1 > f2 || (f1 == f2 && g1 < g2);
+}
+
+void path_search::reach(uint32_t index, tile_pos position, uint32_t parent, uint32_t cost)
+{
+    if (m_stamp[index] == m_search && m_cost[index] <= cost)
+        return;
+    m_stamp[index] = m_search;
+    m_cost[index] = cost;
+    m_parent[index] = parent;
+    // The tile isn't taken out of the open list if it was in there already with a worse cost. That copy is skipped once it comes out instead, as its
+    // cost won't match anymore
+    m_open.push_back({ cost + heuristic(position), cost, index });
+    std::push_heap(m_open.begin(), m_open.end(), [](const open_node &a, const open_node &b) { return worse(a.f, a.g, b.f, b.g); });
+}
+
+void path_search::start(tile_pos from, tile_pos to, path_method method)
+{
+    m_from = from;
+    m_to = to;
+    m_goal = m_grid.index(to.x, to.y);
+    m_method = method;
+    m_open.clear();
+    m_found = false;
+    m_done = false;
+    m_begun = false;
+    m_jumping = false;
+    // Every 4 billion searches, the stamps wrap around, and the old ones could look like they're from this search. Clearing them goes over the whole
+    // map, so it's left to run() (and its deadline)
+    if (++m_search == 0) {
+        m_cleared = 0;
+        m_search = 1;
+    }
+
+    m_explored = { from.x, from.y, from.x, from.y };
+    m_explored.add(to.x, to.y);
+    const uint32_t index = m_grid.index(from.x, from.y);
+    if (!m_grid.in_bounds(from.x, from.y) || !m_grid.in_bounds(to.x, to.y) || !m_grid.walkable(index) || !m_grid.walkable(m_goal))
+        m_done = true;
+}
+
+bool path_search::run(std::chrono::steady_clock::time_point deadline)
+{
+    if (m_done)
+        return true;
+    if (!fill_until(m_stamp, m_cleared, 0, deadline))
+        return false;
+    if (!m_begun) {
+        m_begun = true;
+        const uint32_t index = m_grid.index(m_from.x, m_from.y);
+        reach(index, m_from, index, 0);
+    }
+    // A jump point that it ran out of time in the middle of is finished first
+    if (m_jumping && !expand_jump_point(deadline))
+        return false;
+
+    while (!m_open.empty()) {
+        if (out_of_time(deadline))
+            return false;
+
+        std::pop_heap(m_open.begin(), m_open.end(), [](const open_node &a, const open_node &b) { return worse(a.f, a.g, b.f, b.g); });
+        const open_node node = m_open.back();
+        m_open.pop_back();
+        if (m_cost[node.index] != node.g)
+            continue;  // A better path to it was found after this one went in
+        if (node.index == m_goal) {
+            m_found = true;
+            break;
+        }
+
+        const tile_pos position = m_grid.position(node.index);
+        m_explored.add(position.x, position.y);
+        if (m_method == PATH_A_STAR) {
+            m_work += 8;
+            expand_a_star(node.index, position, node.g);
+        } else {
+            m_jumping = true;
+            m_jumpFrom = node.index;
+            m_jumpCost = node.g;
+            m_direction = 0;
+            m_jumpX = position.x;
+            m_jumpY = position.y;
+            if (!expand_jump_point(deadline))
+                return false;
+        }
+    }
+    m_done = true;
+    return true;
+}
+
+void path_search::expand_a_star(uint32_t index, tile_pos position, uint32_t cost)
+{
+    bool walkable[3][3];
+    neighborhood(m_grid, index, walkable);
+    for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx)
+            if ((dx != 0 || dy != 0) && can_step(walkable, dx, dy))
+                reach(index + dy * m_grid.stride() + dx, { position.x + dx, position.y + dy }, index,
+                    cost + (dx != 0 && dy != 0 ? DIAGONAL_COST : STRAIGHT_COST));
+}
+
+path_search::jump_result path_search::jump(int &x, int &y, int dx, int dy, std::chrono::steady_clock::time_point deadline)
+{
+    const auto never = std::chrono::steady_clock::time_point::max();
+    const int stride = m_grid.stride(), step = dy * stride + dx;
+    uint32_t index = m_grid.index(x, y);
+    while (true) {
+        // A jump can go across the whole map (and a diagonal one looks along a row and a column from every tile), so the clock is checked on the way
+        // too. It's only ever stopped on a tile that it's done with, so going on from there later finds the same thing
+        ++m_work;
+        if (deadline != never && out_of_time(deadline))
+            return JUMP_OUT_OF_TIME;
+
+        // No cutting corners: a diagonal step needs both of the tiles next to it free
+        if (dx != 0 && dy != 0 && (!m_grid.walkable(index + dx) || !m_grid.walkable(index + dy * stride)))
+            return JUMP_WALL;
+        index += step;
+        x += dx;
+        y += dy;
+        if (!m_grid.walkable(index))
+            return JUMP_WALL;
+        m_explored.add(x, y);
+        if (index == m_goal)
+            return JUMP_POINT;
+
+        if (dx != 0 && dy != 0) {
+            // Going diagonally, this is a jump point if going straight along either axis from here leads to one. Those are at most a row or a column
+            // long, so they're never stopped part way (the outer jump stops instead)
+            int jumpX = x, jumpY = y;
+            if (jump(jumpX, jumpY, dx, 0, never) == JUMP_POINT)
+                return JUMP_POINT;
+            jumpX = x;
+            jumpY = y;
+            if (jump(jumpX, jumpY, 0, dy, never) == JUMP_POINT)
+                return JUMP_POINT;
+        } else {
+            // Going straight, this is a jump point if the wall on either side just ended: the best way to the newly free tile could be through here
+            const int side = dx != 0 ? stride : 1;
+            if ((m_grid.walkable(index - side) && !m_grid.walkable(index - side - step)) || (m_grid.walkable(index + side) && !m_grid.walkable(index + side - step)))
+                return JUMP_POINT;
+        }
+    }
+}
+
+bool path_search::expand_jump_point(std::chrono::steady_clock::time_point deadline)
+{
+    const uint32_t index = m_jumpFrom, cost = m_jumpCost;
+    const tile_pos position = m_grid.position(index);
+    // Only the directions that a shortest path could go on in are looked at, given the direction it came from: going diagonally, it can keep going, or
+    // go along either axis. Going straight, it can keep going, or turn to either side (straight or diagonally forward) -- the walls that make the
+    // turns worth taking are what the jumps stop at. The start has no direction, so every way is tried from it
+    const tile_pos parent = m_grid.position(m_parent[index]);
+    const int dx = sign(position.x - parent.x), dy = sign(position.y - parent.y);
+    int directions[8][2];
+    int count = 0;
+    if (dx == 0 && dy == 0) {
+        for (int stepY = -1; stepY <= 1; ++stepY)
+            for (int stepX = -1; stepX <= 1; ++stepX)
+                if (stepX != 0 || stepY != 0) {
+                    directions[count][0] = stepX;
+                    directions[count++][1] = stepY;
+                }
+    } else if (dx != 0 && dy != 0) {
+        const int list[3][2] = { { dx, dy }, { dx, 0 }, { 0, dy } };
+        for (const auto &direction : list) {
+            directions[count][0] = direction[0];
+            directions[count++][1] = direction[1];
+        }
+    } else {
+        // The two sides of the way it's going
+        const int sideX = dy, sideY = dx;
+        const int list[5][2] = { { dx, dy }, { dx + sideX, dy + sideY }, { dx - sideX, dy - sideY }, { sideX, sideY }, { -sideX, -sideY } };
+        for (const auto &direction : list) {
+            directions[count][0] = direction[0];
+            directions[count++][1] = direction[1];
+        }
+    }
+
+    for (; m_direction < count; ++m_direction) {
+        const int dx = directions[m_direction][0], dy = directions[m_direction][1];
+        const jump_result result = jump(m_jumpX, m_jumpY, dx, dy, deadline);
+        if (result == JUMP_OUT_OF_TIME)
+            return false;
+        if (result == JUMP_POINT) {
+            // A jump is always in a straight line, or a diagonal one
+            const uint32_t steps = std::max(std::abs(m_jumpX - position.x), std::abs(m_jumpY - position.y));
+            reach(m_grid.index(m_jumpX, m_jumpY), { m_jumpX, m_jumpY }, index, cost + steps * (dx != 0 && dy != 0 ? DIAGONAL_COST : STRAIGHT_COST));
+        }
+        m_jumpX = position.x;
+        m_jumpY = position.y;
+    }
+    m_jumping = false;
+    return true;
+}
+
+bool path_search::done() const
+{
+    return m_done;
+}
+
+bool path_search::found() const
+{
+    return m_found;
+}
+
+void path_search::path(std::vector<tile_pos> &tiles) const
+{
+    tiles.clear();
+    if (!m_found)
+        return;
+
+    // Going back from the goal, one tile at a time. The tiles that jump point search skipped over are filled back in, by stepping towards the parent
+    const uint32_t start = m_grid.index(m_from.x, m_from.y);
+    uint32_t index = m_goal;
+    tiles.push_back(m_to);
+    while (index != start) {
+        const uint32_t parent = m_parent[index];
+        tile_pos position = m_grid.position(index);
+        const tile_pos parentPosition = m_grid.position(parent);
+        while (position != parentPosition) {
+            position.x += sign(parentPosition.x - position.x);
+            position.y += sign(parentPosition.y - position.y);
+            tiles.push_back(position);
+        }
+        index = parent;
+    }
+    std::reverse(tiles.begin(), tiles.end());
+}
+
+uint32_t path_search::cost() const
+{
+    return m_found ? m_cost[m_goal] : 0;
+}
+
+const explored_area &path_search::explored() const
+{
+    return m_explored;
+}
+
+
+flow_field::flow_field(const walkable_grid &grid)
+    : m_grid{grid}
+{
+    m_cost.resize(grid.size());
+}
+
+void flow_field::start(tile_pos goal)
+{
+    m_goal = goal;
+    m_done = false;
+    m_filled = 0;
+    for (std::vector<uint32_t> &bucket : m_buckets)
+        bucket.clear();
+    m_current = 0;
+    m_waiting = 0;
+    m_explored = { goal.x, goal.y, goal.x, goal.y };
+}
+
+bool flow_field::run(std::chrono::steady_clock::time_point deadline)
+{
+    if (m_done)
+        return true;
+    if (m_filled < m_cost.size()) {
+        if (!fill_until(m_cost, m_filled, UNREACHABLE, deadline))
+            return false;
+        if (!m_grid.in_bounds(m_goal.x, m_goal.y) || !m_grid.walkable(m_grid.index(m_goal.x, m_goal.y))) {
+            m_done = true;
+            return true;
+        }
+        const uint32_t index = m_grid.index(m_goal.x, m_goal.y);
+        m_cost[index] = 0;
+        m_buckets[0].push_back(index);
+        m_waiting = 1;
+    }
+
+    // The same as A*, without a goal (or a heuristic): it goes on until every tile that can reach the goal has its cost
+    for (unsigned steps = 1; m_waiting > 0; ++steps) {
+        std::vector<uint32_t> &bucket = m_buckets[m_current % m_buckets.size()];
+        if (bucket.empty()) {
+            ++m_current;
+            continue;
+        }
+        // Every tile taken out looks at the 8 around it
+        if (steps % (TILES_PER_CLOCK_CHECK / 8) == 0 && std::chrono::steady_clock::now() >= deadline)
+            return false;
+
+        const uint32_t index = bucket.back();
+        bucket.pop_back();
+        --m_waiting;
+        if (m_cost[index] != m_current)
+            continue;  // A cheaper way to it was found after it went in
+
+        const tile_pos position = m_grid.position(index);
+        m_explored.add(position.x, position.y);
+        bool walkable[3][3];
+        neighborhood(m_grid, index, walkable);
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx) {
+                if ((dx == 0 && dy == 0) || !can_step(walkable, dx, dy))
+                    continue;
+                const uint32_t next = index + dy * m_grid.stride() + dx, cost = m_current + (dx != 0 && dy != 0 ? DIAGONAL_COST : STRAIGHT_COST);
+                if (cost < m_cost[next]) {
+                    m_cost[next] = cost;
+                    m_buckets[cost % m_buckets.size()].push_back(next);
+                    ++m_waiting;
+                }
+            }
+    }
+    m_done = true;
+    return true;
+}
+
+bool flow_field::done() const
+{
+    return m_done;
+}
+
+path_status flow_field::status() const
+{
+    if (!m_done)
+        return PATH_PENDING;
+    return cost(m_goal.x, m_goal.y) == 0 ? PATH_FOUND : PATH_NONE;
+}
+
+tile_pos flow_field::goal() const
+{
+    return m_goal;
+}
+
+uint32_t flow_field::cost(int x, int y) const
+{
+    if (!m_done || !m_grid.in_bounds(x, y))
+        return UNREACHABLE;
+    return m_cost[m_grid.index(x, y)];
+}
+
+tile_pos flow_field::next_step(int x, int y) const
+{
+    const uint32_t here = cost(x, y);
+    if (here == UNREACHABLE || here == 0)
+        return { x, y };
+
+    // The neighbor that the cheapest way to the goal goes through. The walkable tiles around a reachable one are all reachable too, so the costs tell
+    // which tiles are walls, without looking at the map (and the border is unreachable)
+    const uint32_t index = m_grid.index(x, y);
+    bool reachable[3][3];
+    for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx)
+            reachable[dy + 1][dx + 1] = m_cost[index + dy * m_grid.stride() + dx] != UNREACHABLE;
+    tile_pos best = { x, y };
+    uint32_t bestCost = here;
+    for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx) {
+            if ((dx == 0 && dy == 0) || !can_step(reachable, dx, dy))
+                continue;
+            const uint32_t cost = m_cost[index + dy * m_grid.stride() + dx] + (dx != 0 && dy != 0 ? DIAGONAL_COST : STRAIGHT_COST);
+            if (cost <= bestCost) {
+                best = { x + dx, y + dy };
+                bestCost = cost;
+            }
+        }
+    return best;
+}
+
+const explored_area &flow_field::explored() const
+{
+    return m_explored;
+}
+
+
+pathfinder::pathfinder(const tilemap &tiles, std::size_t maxPaths, std::size_t maxFields)
+    : m_maxPaths{maxPaths}, m_maxFields{maxFields}, m_grid{tiles}, m_search{m_grid}
+{
+}
+
+uint64_t pathfinder::path_key(tile_pos from, tile_pos to, path_method method) const
+{
+    // The indices of both tiles, and the method in the lowest bit (the map has less than 2^31 tiles)
+    return (uint64_t)m_grid.index(from.x, from.y) << 32 | (uint64_t)m_grid.index(to.x, to.y) << 1 | method;
+}
+
+const std::vector<tile_pos> &pathfinder::path(tile_pos from, tile_pos to, path_status &status, path_method method)
+{
+    static const std::vector<tile_pos> noPath;
+    if (!m_grid.in_bounds(from.x, from.y) || !m_grid.in_bounds(to.x, to.y)) {
+        status = PATH_NONE;
+        return noPath;
+    }
+
+    const uint64_t key = path_key(from, to, method);
+    auto [it, added] = m_paths.try_emplace(key);
+    cached_path &cached = it->second;
+    cached.lastUsed = m_frame;
+    if (added)
+        m_queue.push_back({ false, key });
+    status = cached.status;
+    return cached.tiles;
+}
+
+const flow_field &pathfinder::field(tile_pos goal)
+{
+    const uint64_t key = (uint64_t)(uint32_t)goal.y << 32 | (uint32_t)goal.x;
+    auto [it, added] = m_fields.try_emplace(key);
+    cached_field &cached = it->second;
+    cached.lastUsed = m_frame;
+    if (added) {
+        if (m_spareFields.empty()) {
+            cached.field = std::make_unique<flow_field>(m_grid);
+        } else {
+            cached.field = std::move(m_spareFields.back());
+            m_spareFields.pop_back();
+        }
+        cached.field->start(goal);
+        m_queue.push_back({ true, key });
+    }
+    return *cached.field;
+}
+
+void pathfinder::update(std::chrono::microseconds budget)
+{
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    while (!m_queue.empty()) {
+        const job current = m_queue.front();
+        if (current.isField) {
+            auto it = m_fields.find(current.key);
+            if (it != m_fields.end() && !it->second.field->run(deadline))
+                break;
+        } else if (auto it = m_paths.find(current.key); it != m_paths.end()) {
+            if (!m_started) {
+                m_search.start(m_grid.position(current.key >> 32), m_grid.position((current.key >> 1) & INT32_MAX), (path_method)(current.key & 1));
+                m_started = true;
+            }
+            if (!m_search.run(deadline))
+                break;
+            cached_path &cached = it->second;
+            cached.status = m_search.found() ? PATH_FOUND : PATH_NONE;
+            m_search.path(cached.tiles);
+            cached.explored = m_search.explored();
+        }
+        m_queue.pop_front();
+        m_started = false;
+        if (std::chrono::steady_clock::now() >= deadline)
+            break;
+    }
+    trim();
+    ++m_frame;
+}
+
+void pathfinder::trim()
+{
+    // The ones still waiting in the queue are never thrown out, someone's waiting for them
+    if (m_paths.size() > m_maxPaths) {
+        m_evict.clear();
+        for (const auto &[key, cached] : m_paths)
+            if (cached.status != PATH_PENDING)
+                m_evict.push_back({ cached.lastUsed, key });
+        const std::size_t overflow = std::min(m_paths.size() - m_maxPaths, m_evict.size());
+        std::nth_element(m_evict.begin(), m_evict.begin() + overflow, m_evict.end());
+        for (std::size_t i = 0; i < overflow; ++i)
+            m_paths.erase(m_evict[i].second);
+    }
+    if (m_fields.size() > m_maxFields) {
+        m_evict.clear();
+        for (const auto &[key, cached] : m_fields)
+            if (cached.field->done())
+                m_evict.push_back({ cached.lastUsed, key });
+        const std::size_t overflow = std::min(m_fields.size() - m_maxFields, m_evict.size());
+        std::nth_element(m_evict.begin(), m_evict.begin() + overflow, m_evict.end());
+        for (std::size_t i = 0; i < overflow; ++i) {
+            auto it = m_fields.find(m_evict[i].second);
+            m_spareFields.push_back(std::move(it->second.field));
+            m_fields.erase(it);
+        }
+    }
+}
+
+void pathfinder::mark_dirty(int x1, int y1, int x2, int y2)
+{
+    m_grid.refresh(x1, y1, x2, y2);
+    std::erase_if(m_paths, [&](const auto &entry)
+    {
+        return entry.second.status != PATH_PENDING && entry.second.explored.touches(x1, y1, x2, y2);
+    });
+    // A search that's half done has to start over if what it's looked at so far changed
+    if (m_started && !m_queue.front().isField && m_search.explored().touches(x1, y1, x2, y2))
+        m_started = false;
+
+    for (auto it = m_fields.begin(); it != m_fields.end();) {
+        flow_field &field = *it->second.field;
+        if (!field.explored().touches(x1, y1, x2, y2)) {
+            ++it;
+        } else if (!field.done()) {
+            field.start(field.goal());
+            ++it;
+        } else {
+            m_spareFields.push_back(std::move(it->second.field));
+            it = m_fields.erase(it);
+        }
+    }
+}
+
+void pathfinder::mark_all_dirty()
+{
+    mark_dirty(0, 0, m_grid.width() - 1, m_grid.height() - 1);
+}
+
+std::size_t pathfinder::cached_paths() const
+{
+    return m_paths.size();
+}
+
+std::size_t pathfinder::cached_fields() const
+{
+    return m_fields.size();
+}
+
+std::size_t pathfinder::queued() const
+{
+    return m_queue.size();
+}
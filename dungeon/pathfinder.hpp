@@ -0,0 +1,251 @@
+#ifndef GAMES_DUNGEON_PATHFINDER_HPP
+#define GAMES_DUNGEON_PATHFINDER_HPP
+
+#include <array>          // std::array
+#include <vector>         // std::vector
+#include <deque>          // std::deque
+#include <memory>         // std::unique_ptr
+#include <unordered_map>  // std::unordered_map
+#include <chrono>         // std::chrono::steady_clock, std::chrono::microseconds
+#include <cstdint>        // uint32_t, uint64_t
+#include <cstddef>        // std::size_t
+#include <utility>        // std::pair
+
+#include "tilemap.hpp"
+
+// Pathfinding over the tiles of a dungeon. Every tile that isn't rock can be walked on, and you can move to any of the 8 tiles around you -- diagonally
+// only if both of the tiles you'd squeeze past are free, so that nobody cuts through the corner of a wall. A straight step costs 10 and a diagonal one
+// 14 (about 10 * sqrt(2), kept in integers so that costs add up exactly).
+const uint32_t STRAIGHT_COST = 10, DIAGONAL_COST = 14;
+
+// A position on the tile map
+struct tile_pos
+{
+    int x, y;
+
+    bool operator==(const tile_pos &other) const = default;
+};
+
+// How a single path is searched for. Both find a shortest path; jump point search skips over the long straight stretches of a corridor or room without
+// putting every tile of them into the open list, so it's usually a lot quicker on dungeon-like maps
+enum path_method
+{
+    PATH_A_STAR,
+    PATH_JUMP_POINT,
+};
+
+enum path_status
+{
+    PATH_PENDING,  // Not worked out yet (see pathfinder::update)
+    PATH_FOUND,
+    PATH_NONE,  // There's no way to get there
+};
+
+// The box around every tile a search has looked at (inclusive). A search only depends on the tiles in it, so changing tiles outside of it can't change
+// the result -- the box is grown by a tile on every side, as whether a tile can be walked on is always checked from right next to it
+struct explored_area
+{
+    int x1, y1, x2, y2;
+
+    void add(int x, int y)
+    {
+        x1 = x < x1 ? x : x1;
+        y1 = y < y1 ? y : y1;
+        x2 = x > x2 ? x : x2;
+        y2 = y > y2 ? y : y2;
+    }
+    // Whether a change to the tiles between two corners (inclusive, in any order) could change the result
+    bool touches(int changedX1, int changedY1, int changedX2, int changedY2) const;
+};
+
+// Which tiles of a map can be walked on, one byte per tile, with a border of walls around the whole thing. It's what the searches look at instead of the
+// tile map: finding a tile is a single array lookup (rather than going through the chunks), and the tiles around any tile on the map can be looked at
+// without checking whether they're off the edge. The tiles are referred to by their index in the array, so that the tiles around one are just a fixed
+// offset away from it (1 to the left and right, stride() up and down). It's a copy, so it has to be told about every change to the tiles.
+class walkable_grid final
+{
+    const tilemap &m_tiles;
+    const int m_width, m_height;
+    const int m_stride;  // The width of a row of the array, with the border
+    std::vector<uint8_t> m_walkable;
+
+public:
+    explicit walkable_grid(const tilemap &tiles);  // Copies the whole map. The map has to stay alive, and the same size, for as long as the grid is used
+    walkable_grid(const walkable_grid &) = delete;
+
+    void refresh(int x1, int y1, int x2, int y2);  // Copies the tiles in between the two corners (inclusive, in any order) again
+    int width() const;
+    int height() const;
+    bool in_bounds(int x, int y) const;
+
+    int stride() const { return m_stride; }
+    std::size_t size() const { return m_walkable.size(); }  // How many indices there are, border included
+    uint32_t index(int x, int y) const { return (y + 1) * m_stride + x + 1; }  // Works for the border too (one tile off the map)
+    tile_pos position(uint32_t index) const { return { (int)(index % m_stride) - 1, (int)(index / m_stride) - 1 }; }
+    bool walkable(uint32_t index) const { return m_walkable[index]; }
+};
+
+// One search for a path from one tile to another, with A* or jump point search. It can be stopped part way when it runs out of time, and picked up from
+// there later. Whatever the search needs per tile is kept in arrays the size of the map, which are allocated once and reused by every search (together
+// with the open list): each tile remembers which search last wrote to it, so nothing has to be cleared in between searches.
+class path_search final
+{
+    // A tile waiting in the open list. f is the cost of the path so far (g) plus the estimate of what's left
+    struct open_node
+    {
+        uint32_t f, g;
+        uint32_t index;
+    };
+
+    const walkable_grid &m_grid;
+    std::vector<uint32_t> m_cost;  // The cost of the best path found to every tile so far (by its index in the grid)
+    std::vector<uint32_t> m_parent;  // The tile that the best path to every tile came from (a jump point, for jump point search)
+    std::vector<uint32_t> m_stamp;  // The search that last wrote to m_cost and m_parent of every tile. If it's not this one, the tile isn't reached yet
+    uint32_t m_search = 0;
+    std::size_t m_cleared;  // How much of m_stamp is cleared. It's all of it, except after the stamps wrapped around (then run() clears them bit by bit)
+    std::vector<open_node> m_open;  // A min-heap on f
+
+    tile_pos m_from, m_to;
+    uint32_t m_goal;  // The index of m_to
+    path_method m_method;
+    bool m_done = true, m_found = false;
+    bool m_begun = false;  // Whether run() has put the start into the open list yet
+    explored_area m_explored;
+    unsigned m_work = 0;  // How many tiles were looked at since the clock was last checked
+
+    // Where jump point search is at, when it ran out of time part way through jumping from a jump point: the jump point (and the cost to it), the
+    // direction it was jumping in (its number in the list of directions worth trying), and how far it got
+    bool m_jumping = false;
+    uint32_t m_jumpFrom, m_jumpCost;
+    int m_direction, m_jumpX, m_jumpY;
+
+    // What a jump found
+    enum jump_result
+    {
+        JUMP_POINT,
+        JUMP_WALL,
+        JUMP_OUT_OF_TIME,  // It stopped on the way (x and y are where it got to, it carries on from there)
+    };
+
+    bool out_of_time(std::chrono::steady_clock::time_point deadline);  // Whether it's past the deadline, only checking the clock every so often
+    uint32_t heuristic(tile_pos position) const;  // The cost to the goal, if there were no walls in the way
+    void reach(uint32_t index, tile_pos position, uint32_t parent, uint32_t cost);  // Records a path to a tile, if it's the best one yet
+    void expand_a_star(uint32_t index, tile_pos position, uint32_t cost);
+    // Jumps from m_jumpFrom in every direction worth going in, starting with m_direction (from m_jumpX, m_jumpY). Returns false if it ran out of time
+    bool expand_jump_point(std::chrono::steady_clock::time_point deadline);
+    jump_result jump(int &x, int &y, int dx, int dy, std::chrono::steady_clock::time_point deadline);  // Moves from (x, y) in the direction until it finds something
+
+public:
+    explicit path_search(const walkable_grid &grid);
+
+    void start(tile_pos from, tile_pos to, path_method method);  // Starts a new search (forgetting whatever's left of the last one)
+    // Keeps searching until the search is done (true) or it's past the deadline (false). The clock is checked every hundred or so tiles looked at (even
+    // in the middle of a long jump), so it can only overshoot the deadline by a little
+    bool run(std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    bool done() const;
+    bool found() const;
+    void path(std::vector<tile_pos> &tiles) const;  // Gives the path, every tile of it from the start to the goal (empty if there's none)
+    uint32_t cost() const;  // The cost of the path that was found
+    const explored_area &explored() const;
+};
+
+// The cost of getting from every tile to a goal (Dijkstra's algorithm, from the goal outwards), and so the best step to take from every tile. Any amount
+// of agents going to the same place can share one, and each of them only has to look at the tiles around it to know where to go next. Like a
+// path_search, it can be worked out a bit at a time. It keeps a cost per tile of the whole map.
+class flow_field final
+{
+    const walkable_grid &m_grid;
+    std::vector<uint32_t> m_cost;  // By the index in the grid. UNREACHABLE for the tiles that can't get to the goal (or aren't reached yet), and the border
+    // The tiles waiting to be looked at, sorted by cost into buckets (a bucket queue, quicker than a heap when the costs are small whole numbers). A step
+    // costs at most DIAGONAL_COST, so only that many costs past the current one can have tiles waiting, and the buckets are used round and round
+    std::array<std::vector<uint32_t>, DIAGONAL_COST + 1> m_buckets;
+    uint32_t m_current = 0;  // The cost of the tiles being looked at now
+    std::size_t m_waiting = 0;  // How many tiles are in the buckets
+    tile_pos m_goal = { 0, 0 };
+    bool m_done = true;
+    // How much of m_cost run() has set to UNREACHABLE yet. That takes going over the whole map, so it's done a piece at a time, within run()'s deadline
+    std::size_t m_filled = 0;
+    explored_area m_explored;
+
+public:
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+    explicit flow_field(const walkable_grid &grid);
+
+    void start(tile_pos goal);
+    bool run(std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());  // Same as path_search::run
+
+    bool done() const;
+    path_status status() const;  // PATH_NONE if the goal itself can't be walked on
+    tile_pos goal() const;
+    uint32_t cost(int x, int y) const;  // The cost of the best path from a tile to the goal, or UNREACHABLE
+    // The tile to step to from (x, y) to get closer to the goal. Gives (x, y) back if it's the goal, or there's no way to the goal from there
+    tile_pos next_step(int x, int y) const;
+    const explored_area &explored() const;
+};
+
+// Paths and flow fields for everything in the dungeon, with a time budget per frame. Asking for one gives back what's in the cache, or queues it up and
+// says it's pending. update() then works through the queue, once a frame, until it runs out of time -- a search that doesn't fit is carried on in the
+// next frame, so a lot of agents asking for paths at once only spreads the work out, instead of making a frame take long.
+//
+// The results are cached, and stay there until they haven't been asked for in a while (the least recently used ones are thrown out once there are too
+// many), or the tiles they were worked out from change. Like tile_renderer, every change to the tiles has to be marked dirty -- only the results whose
+// explored area it touches are thrown out. It has to be marked dirty before update() is called again, as the searches only look at their own copy of
+// which tiles are walkable (see walkable_grid).
+class pathfinder final
+{
+    struct cached_path
+    {
+        path_status status = PATH_PENDING;
+        std::vector<tile_pos> tiles;
+        explored_area explored;
+        uint64_t lastUsed;
+    };
+    struct cached_field
+    {
+        std::unique_ptr<flow_field> field;
+        uint64_t lastUsed;
+    };
+    // Something in the queue. Paths and flow fields are looked up by a key made from their tiles (and method)
+    struct job
+    {
+        bool isField;
+        uint64_t key;
+    };
+
+    const std::size_t m_maxPaths, m_maxFields;
+    walkable_grid m_grid;  // Kept up to date by mark_dirty()
+    path_search m_search;  // Every path is searched for with this one, so they all share its memory
+    std::unordered_map<uint64_t, cached_path> m_paths;
+    std::unordered_map<uint64_t, cached_field> m_fields;
+    std::vector<std::unique_ptr<flow_field>> m_spareFields;  // Thrown out of the cache, kept around so that their memory can be reused
+    std::deque<job> m_queue;
+    bool m_started = false;  // Whether the job at the front of the queue has been started
+    uint64_t m_frame = 0;  // How many times update() was called, for telling how recently something was used
+    std::vector<std::pair<uint64_t, uint64_t>> m_evict;  // Scratch space for throwing things out of the cache (last used, key)
+
+    uint64_t path_key(tile_pos from, tile_pos to, path_method method) const;
+    void trim();  // Throws the least recently used results out of the cache until it's within its limits
+
+public:
+    // Keeps up to maxPaths paths and maxFields flow fields cached (flow fields are the size of the whole map, so there shouldn't be many of them)
+    explicit pathfinder(const tilemap &tiles, std::size_t maxPaths = 1024, std::size_t maxFields = 8);
+    pathfinder(const pathfinder &) = delete;
+
+    // Gives the path between two tiles, if it's been worked out already (PATH_PENDING otherwise, in which case it's queued up). The returned results
+    // stay valid until the next call to update(), mark_dirty() or mark_all_dirty()
+    const std::vector<tile_pos> &path(tile_pos from, tile_pos to, path_status &status, path_method method = PATH_JUMP_POINT);
+    const flow_field &field(tile_pos goal);  // The flow field to a goal. It's only usable once its status isn't PATH_PENDING anymore
+
+    // Works through the queue for (roughly) the given amount of time. Call it once a frame
+    void update(std::chrono::microseconds budget);
+    void mark_dirty(int x1, int y1, int x2, int y2);  // Tells that the tiles in between the two corners (inclusive) changed
+    void mark_all_dirty();  // Throws out everything, and starts over whatever is being worked on
+
+    std::size_t cached_paths() const;
+    std::size_t cached_fields() const;
+    std::size_t queued() const;
+};
+
+#endif  // GAMES_DUNGEON_PATHFINDER_HPP
@@ -0,0 +1,142 @@
+#include "raster.hpp"
+
+#include <algorithm>  // std::max
+#include <cstdlib>    // std::abs
+
+void fill_rect(tilemap &tiles, int x1, int y1, int x2, int y2, uint8_t tile)
+{
+    tiles.fill_rect(x1, y1, x2, y2, tile);
+}
+
+void draw_hline(tilemap &tiles, int x1, int x2, int y, uint8_t tile)
+{
+    tiles.fill_span(x1, x2, y, tile);
+}
+
+void draw_vline(tilemap &tiles, int x, int y1, int y2, uint8_t tile)
+{
+    tiles.fill_column(x, y1, y2, tile);
+}
+
+void draw_line(tilemap &tiles, int x1, int y1, int x2, int y2, uint8_t tile)
+{
+    // Bresenham's line algorithm: step along one tile at a time, and keep track of how far off the real line we are (error). Whenever it's more than
+    // half a tile, step on the other axis as well
+    const int dx = std::abs(x2 - x1), dy = -std::abs(y2 - y1);
+    const int stepX = x1 < x2 ? 1 : -1, stepY = y1 < y2 ? 1 : -1;
+    int error = dx + dy;
+    while (true) {
+        if (tiles.in_bounds(x1, y1))
+            tiles.set(x1, y1, tile);
+        if (x1 == x2 && y1 == y2)
+            break;
+        int doubled = 2 * error;
+        if (doubled >= dy) {
+            error += dy;
+            x1 += stepX;
+        }
+        if (doubled <= dx) {
+            error += dx;
+            y1 += stepY;
+        }
+    }
+}
+
+void draw_staircase(tilemap &tiles, int x1, int y1, int x2, int y2, int nsegments, uint8_t tile)
+{
+    // The corners of the staircase are worked out as they're needed, instead of being put in lists first. The steps go along the longer axis, and
+    // the segments in between them along the shorter one
+    nsegments = std::max(nsegments, 1);
+    auto along = [&](int i, int from, int to) -> int
+    {
+        float t = (float)i / nsegments;
+        return (1-t) * from + t * to;
+    };
+    auto across = [&](int i, int from, int to) -> int
+    {
+        if (nsegments == 1)
+            return from;
+        float t = (float)i / (nsegments-1);
+        return (1-t) * from + t * to;
+    };
+
+    if (std::abs(x2 - x1) < std::abs(y2 - y1)) {
+        for (int i = 0; i < nsegments; ++i) {
+            draw_vline(tiles, across(i, x1, x2), along(i, y1, y2), along(i + 1, y1, y2), tile);
+            if (i != nsegments - 1)
+                draw_hline(tiles, across(i, x1, x2), across(i + 1, x1, x2), along(i + 1, y1, y2), tile);
+        }
+    } else {
+        for (int i = 0; i < nsegments; ++i) {
+            draw_hline(tiles, along(i, x1, x2), along(i + 1, x1, x2), across(i, y1, y2), tile);
+            if (i != nsegments - 1)
+                draw_vline(tiles, along(i + 1, x1, x2), across(i, y1, y2), across(i + 1, y1, y2), tile);
+        }
+    }
+}
+
+void fill_circle(tilemap &tiles, int centerX, int centerY, int radius, uint8_t tile)
+{
+    // Going from the middle row outwards, the rows only ever get narrower, so the half width is just shrunk until it fits
+    int halfWidth = radius;
+    for (int dy = 0; dy <= radius; ++dy) {
+        while (halfWidth * halfWidth + dy * dy > radius * radius)
+            --halfWidth;
+        tiles.fill_span(centerX - halfWidth, centerX + halfWidth, centerY + dy, tile);
+        if (dy != 0)
+            tiles.fill_span(centerX - halfWidth, centerX + halfWidth, centerY - dy, tile);
+    }
+}
+
+std::size_t flood_fill(tilemap &tiles, int x, int y, uint8_t tile, std::vector<flood_span> &stack)
+{
+    if (!tiles.in_bounds(x, y))
+        return 0;
+    const uint8_t original = tiles.at(x, y);
+    if (original == tile)
+        return 0;
+    auto inside = [&](int x, int y) { return tiles.in_bounds(x, y) && tiles.at(x, y) == original; };
+
+    // A span filling flood fill: every entry of the stack is a part of a row to look at, along with the direction (dy) of the row it was found from.
+    // Each row is scanned for runs of tiles to change, which are filled in all at once, and the rows above and below them are queued. The parts of the
+    // row it came from that stick out past the row that queued it are queued too, as those haven't been looked at yet
+    std::size_t count = 0;
+    auto fill = [&](int x1, int x2, int y)
+    {
+        tiles.fill_span(x1, x2, y, tile);
+        count += x2 - x1 + 1;
+    };
+    stack.clear();
+    stack.push_back({ x, x, y, 1 });
+    stack.push_back({ x, x, y - 1, -1 });
+    while (!stack.empty()) {
+        auto [x1, x2, y, dy] = stack.back();
+        stack.pop_back();
+
+        int start = x1;
+        if (inside(start, y)) {
+            while (inside(start - 1, y))
+                --start;
+            if (start < x1) {
+                fill(start, x1 - 1, y);
+                stack.push_back({ start, x1 - 1, y - dy, -dy });
+            }
+        }
+        while (x1 <= x2) {
+            int runStart = x1;
+            while (inside(x1, y))
+                ++x1;
+            if (x1 > runStart)
+                fill(runStart, x1 - 1, y);
+            if (x1 > start)
+                stack.push_back({ start, x1 - 1, y + dy, dy });
+            if (x1 - 1 > x2)
+                stack.push_back({ x2 + 1, x1 - 1, y - dy, -dy });
+            ++x1;
+            while (x1 < x2 && !inside(x1, y))
+                ++x1;
+            start = x1;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,30 @@
+#ifndef GAMES_DUNGEON_RASTER_HPP
+#define GAMES_DUNGEON_RASTER_HPP
+
+#include <vector>   // std::vector
+#include <cstdint>  // uint8_t
+#include <cstddef>  // std::size_t
+
+#include "tilemap.hpp"
+
+// Functions that draw shapes into a tile map. Every one of them cuts off whatever is off the map, and fills whole rows at once where it can (see
+// tilemap::fill_rect). None of them allocate memory -- besides the chunks of the map itself, and the flood fill's stack until it's big enough.
+
+void fill_rect(tilemap &tiles, int x1, int y1, int x2, int y2, uint8_t tile);  // Fills the rectangle in between two corners (inclusive, in any order)
+void draw_hline(tilemap &tiles, int x1, int x2, int y, uint8_t tile);
+void draw_vline(tilemap &tiles, int x, int y1, int y2, uint8_t tile);
+void draw_line(tilemap &tiles, int x1, int y1, int x2, int y2, uint8_t tile);  // A straight line (Bresenham's), with one tile per step along the longer axis
+// A staircase from one point to the other, made of nsegments horizontal and vertical lines, with no diagonal steps (so that it can be walked along)
+void draw_staircase(tilemap &tiles, int x1, int y1, int x2, int y2, int nsegments, uint8_t tile);
+void fill_circle(tilemap &tiles, int centerX, int centerY, int radius, uint8_t tile);  // Every tile whose middle is within radius of the center
+
+// A row of tiles left to be looked at by flood_fill, along with the direction it was reached from
+struct flood_span
+{
+    int x1, x2, y, dy;
+};
+// Changes every tile that's connected to (x, y) (not counting diagonals) through tiles of the same kind as it, to `tile`. stack is scratch space,
+// which can be reused from call to call to avoid allocating. Returns how many tiles were changed
+std::size_t flood_fill(tilemap &tiles, int x, int y, uint8_t tile, std::vector<flood_span> &stack);
+
+#endif  // GAMES_DUNGEON_RASTER_HPP
@@ -0,0 +1,145 @@
+#include "room_graph.hpp"
+
+#include <algorithm>  // std::lower_bound
+#include <stdexcept>  // std::out_of_range, std::invalid_argument
+
+room_graph::room_graph(int width, int height)
+    : m_width{width}, m_height{height}, m_cells((std::size_t)width * height, NO_ROOM), m_rows(height), m_columns(width)
+{
+}
+
+int room_graph::width() const
+{
+    return m_width;
+}
+
+int room_graph::height() const
+{
+    return m_height;
+}
+
+void room_graph::link_neighbors(std::vector<std::pair<int, room_id>> &line, int position, room_id id, direction before, direction after)
+{
+    auto iter = std::lower_bound(line.begin(), line.end(), std::pair{position, id});
+    iter = line.insert(iter, { position, id });
+
+    // The rooms right before and after it in the line are its neighbors, and it becomes theirs, in place of each other
+    room &me = m_rooms[id];
+    if (iter != line.begin()) {
+        auto [otherPosition, other] = *(iter - 1);
+        me.neighbors[before] = { other, (unsigned)(position - otherPosition) };
+        m_rooms[other].neighbors[after] = { id, (unsigned)(position - otherPosition) };
+    }
+    if (iter + 1 != line.end()) {
+        auto [otherPosition, other] = *(iter + 1);
+        me.neighbors[after] = { other, (unsigned)(otherPosition - position) };
+        m_rooms[other].neighbors[before] = { id, (unsigned)(otherPosition - position) };
+    }
+}
+
+room_id room_graph::add_room(int x, int y, int mapX1, int mapY1, int mapX2, int mapY2)
+{
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+        throw std::out_of_range("the cell of a room has to be on the grid");
+    room_id &cell = m_cells[y * m_width + x];
+    if (cell != NO_ROOM)
+        throw std::invalid_argument("there's already a room in that cell");
+
+    room_id id = m_rooms.size();
+    m_rooms.push_back({ x, y, mapX1, mapY1, mapX2, mapY2, {}, {} });
+    cell = id;
+    m_components.add();
+    link_neighbors(m_rows[y], x, id, DIR_LEFT, DIR_RIGHT);
+    link_neighbors(m_columns[x], y, id, DIR_UP, DIR_DOWN);
+    ++m_taintID;
+    return id;
+}
+
+uint32_t room_graph::connect(room_id room1, room_id room2, int x1, int y1, int x2, int y2)
+{
+    uint32_t id = m_connections.size();
+    m_connections.push_back({ room1, room2, x1, y1, x2, y2 });
+    m_rooms[room1].connections.push_back(id);
+    m_rooms[room2].connections.push_back(id);
+    m_components.unite(room1, room2);
+    ++m_taintID;
+    return id;
+}
+
+void room_graph::clear()
+{
+    // The lists are emptied rather than thrown away, so that making the next dungeon doesn't allocate them again
+    for (const room &r : m_rooms) {
+        m_cells[r.y * m_width + r.x] = NO_ROOM;
+        m_rows[r.y].clear();
+        m_columns[r.x].clear();
+    }
+    m_rooms.clear();
+    m_connections.clear();
+    m_components.clear();
+    ++m_taintID;
+}
+
+room_id room_graph::at_cell(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+        return NO_ROOM;
+    return m_cells[y * m_width + x];
+}
+
+const room_neighbor &room_graph::neighbor(room_id id, direction dir) const
+{
+    return m_rooms[id].neighbors[dir];
+}
+
+const room &room_graph::get(room_id id) const
+{
+    return m_rooms[id];
+}
+
+const std::vector<room> &room_graph::rooms() const
+{
+    return m_rooms;
+}
+
+const std::vector<room_connection> &room_graph::connections() const
+{
+    return m_connections;
+}
+
+unsigned room_graph::taint() const
+{
+    return m_taintID;
+}
+
+bool room_graph::connected(room_id room1, room_id room2) const
+{
+    return m_components.connected(room1, room2);
+}
+
+room_id room_graph::component(room_id id) const
+{
+    return m_components.find(id);
+}
+
+std::size_t room_graph::component_count() const
+{
+    return m_components.groups();
+}
+
+std::vector<std::vector<room_id>> room_graph::find_disjoint() const
+{
+    // Every group gets a slot in the list the first time one of its rooms comes up. The slot is remembered by the group's representative
+    std::vector<std::vector<room_id>> groups;
+    groups.reserve(m_components.groups());
+    std::vector<uint32_t> slot(m_rooms.size(), UINT32_MAX);
+    for (room_id id = 0; id < m_rooms.size(); ++id) {
+        uint32_t &groupSlot = slot[m_components.find(id)];
+        if (groupSlot == UINT32_MAX) {
+            groupSlot = groups.size();
+            groups.emplace_back();
+        }
+        groups[groupSlot].push_back(id);
+    }
+    return groups;
+}
@@ -0,0 +1,100 @@
+#ifndef GAMES_DUNGEON_ROOM_GRAPH_HPP
+#define GAMES_DUNGEON_ROOM_GRAPH_HPP
+
+#include <array>    // std::array
+#include <vector>   // std::vector
+#include <cstdint>  // uint32_t
+#include <utility>  // std::pair
+#include <cstddef>  // std::size_t
+
+#include "disjoint_sets.hpp"
+
+// Rooms are referred to by their number, in the order they were added
+using room_id = uint32_t;
+const room_id NO_ROOM = UINT32_MAX;
+
+// The four directions a room can have a neighbor in. The y axis goes down, like on the screen
+enum direction
+{
+    DIR_DOWN,
+    DIR_UP,
+    DIR_LEFT,
+    DIR_RIGHT,
+};
+const int DIR_X[4] = { 0, 0, -1, 1 }, DIR_Y[4] = { 1, -1, 0, 0 };
+
+// The closest room in some direction, and how many cells away it is
+struct room_neighbor
+{
+    room_id room = NO_ROOM;
+    unsigned distance = 0;
+};
+
+// A corridor between two rooms, from (x1, y1) in the first one to (x2, y2) in the second one (in tiles)
+struct room_connection
+{
+    room_id room1, room2;
+    int x1, y1, x2, y2;
+
+    room_id other(room_id me) const { return me == room1 ? room2 : room1; }
+};
+
+// A single room of the dungeon. It sits in a cell of the room graph's grid, and takes up a rectangle of the tile map (from (mapX1, mapY1) to (mapX2,
+// mapY2), inclusive)
+struct room
+{
+    int x, y;
+    int mapX1, mapY1, mapX2, mapY2;
+    std::array<room_neighbor, 4> neighbors;  // The closest room in every direction (indexed by direction)
+    std::vector<uint32_t> connections;  // The corridors leading out of it (indices into room_graph::connections())
+};
+
+// The layout of a dungeon: rooms on a grid of cells (at most one per cell), and the corridors connecting them. Finding the room in a cell is O(1) (every
+// cell stores the room in it), and so is finding the closest room in some direction, as every room keeps its four neighbors up to date. Those are found
+// from a sorted list of the rooms on every row and column of the grid, so adding a room only has to look at the rooms on its own row and column.
+//
+// Which rooms are connected to each other (through any amount of corridors) is kept up to date as corridors are added, so asking whether two rooms are
+// connected, or how many separate parts the dungeon is in, is practically O(1) (see disjoint_sets.hpp).
+//
+// Every change to the graph bumps its taint counter, so anything worked out from the graph (say, paths through it) can tell when it's out of date by
+// remembering the counter it was made at.
+class room_graph final
+{
+    const int m_width, m_height;  // The size of the grid, in cells
+    std::vector<room> m_rooms;
+    std::vector<room_connection> m_connections;
+    std::vector<room_id> m_cells;  // The room in every cell, row by row (NO_ROOM for empty ones)
+    std::vector<std::vector<std::pair<int, room_id>>> m_rows, m_columns;  // The rooms on every row (sorted by x) and column (sorted by y)
+    disjoint_sets m_components;  // Which rooms are connected to each other. The rooms are numbered the same way in it
+    unsigned m_taintID = 0;
+
+    // Finds where a room at `position` goes in a sorted row or column, and updates its neighbors (and theirs) on both sides
+    void link_neighbors(std::vector<std::pair<int, room_id>> &line, int position, room_id id, direction before, direction after);
+
+public:
+    room_graph(int width, int height);  // Makes an empty graph of the given size (in cells)
+
+    int width() const;
+    int height() const;
+
+    // Adds a room to a cell, taking up the given rectangle of the tile map. Throws std::out_of_range if the cell isn't on the grid, and
+    // std::invalid_argument if there's a room in it already
+    room_id add_room(int x, int y, int mapX1, int mapY1, int mapX2, int mapY2);
+    // Connects two rooms with a corridor, from (x1, y1) to (x2, y2) (in tiles). Gives the number of the connection
+    uint32_t connect(room_id room1, room_id room2, int x1, int y1, int x2, int y2);
+    void clear();  // Removes every room and connection
+
+    room_id at_cell(int x, int y) const;  // The room in a cell, or NO_ROOM if it's empty (or off the grid)
+    const room_neighbor &neighbor(room_id id, direction dir) const;  // The closest room in some direction (room is NO_ROOM if there's none)
+    const room &get(room_id id) const;
+    const std::vector<room> &rooms() const;
+    const std::vector<room_connection> &connections() const;
+    unsigned taint() const;  // Changes whenever the graph does
+
+    bool connected(room_id room1, room_id room2) const;  // Whether there's a way from one room to the other, through any amount of corridors
+    room_id component(room_id id) const;  // The representative of the group of rooms connected to a room. Rooms that are connected share it
+    std::size_t component_count() const;  // How many separate groups of connected rooms there are (1 once the whole dungeon is connected)
+    std::vector<std::vector<room_id>> find_disjoint() const;  // Lists the rooms of every separate group, in order of the first room in each
+};
+
+#endif  // GAMES_DUNGEON_ROOM_GRAPH_HPP
@@ -0,0 +1,79 @@
+#include "tile_renderer.hpp"
+
+tile_renderer::tile_renderer(SDL_Renderer *renderer, int width, int height)
+    : m_width{width}, m_height{height}
+{
+    m_texture = sdlCall(SDL_CreateTexture)(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+    // Every tile is a single pixel, stretched to many pixels on the screen. The default (linear) scaling would blur the tiles into each other
+    sdlCall(SDL_SetTextureScaleMode)(m_texture, SDL_ScaleModeNearest);
+    m_palette.fill(pack({ 0, 0, 0, 255 }));
+    m_hidden = pack({ 0, 0, 0, 255 });
+    mark_all_dirty();
+}
+
+tile_renderer::~tile_renderer()
+{
+    sdlCall(SDL_DestroyTexture)(m_texture);
+}
+
+uint32_t tile_renderer::pack(SDL_Color color)
+{
+    return (uint32_t)color.a << 24 | (uint32_t)color.r << 16 | (uint32_t)color.g << 8 | color.b;
+}
+
+void tile_renderer::set_color(uint8_t tile, SDL_Color color)
+{
+    m_palette[tile] = pack(color);
+    // We don't know where the tiles of that kind are, so all of them are redrawn. The palette is only meant to be set up once, so it's fine
+    mark_all_dirty();
+}
+
+void tile_renderer::set_hidden_color(SDL_Color color)
+{
+    m_hidden = pack(color);
+    mark_all_dirty();
+}
+
+void tile_renderer::mark_dirty(int x1, int y1, int x2, int y2)
+{
+    if (x1 > x2)
+        std::swap(x1, x2);
+    if (y1 > y2)
+        std::swap(y1, y2);
+    // Clip it to the map. If nothing's left, there's nothing to do
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, m_width - 1);
+    y2 = std::min(y2, m_height - 1);
+    if (x1 > x2 || y1 > y2)
+        return;
+
+    // The dirty area is kept as a single rectangle that covers every change. Changes far apart make it bigger than it has to be, but a single lock is
+    // still cheaper than many small ones
+    m_dirtyX1 = std::min(m_dirtyX1, x1);
+    m_dirtyY1 = std::min(m_dirtyY1, y1);
+    m_dirtyX2 = std::max(m_dirtyX2, x2);
+    m_dirtyY2 = std::max(m_dirtyY2, y2);
+}
+
+void tile_renderer::mark_all_dirty()
+{
+    m_dirtyX1 = m_dirtyY1 = 0;
+    m_dirtyX2 = m_width - 1;
+    m_dirtyY2 = m_height - 1;
+}
+
+void tile_renderer::draw(render_queue &queue, int layer, const SDL_FRect &dst) const
+{
+    queue.copy(layer, m_texture, m_width, m_height, { 0, 0, m_width, m_height }, dst);
+}
+
+int tile_renderer::width() const
+{
+    return m_width;
+}
+
+int tile_renderer::height() const
+{
+    return m_height;
+}
@@ -0,0 +1,82 @@
+#ifndef GAMES_DUNGEON_TILE_RENDERER_HPP
+#define GAMES_DUNGEON_TILE_RENDERER_HPP
+
+#include <array>    // std::array
+#include <cstdint>  // uint8_t, uint32_t
+#include <algorithm>  // std::min, std::max
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+
+#include "../utils.hpp"
+#include "../render_queue.hpp"
+
+// Draws a map of tiles as a single texture, with one pixel per tile, stretched over the screen. Drawing the map is then a single textured quad no
+// matter how big it is. The texture is a streaming one, so changing it is cheap: only the part of it where tiles changed (the dirty area) is written,
+// the rest is left as is.
+class tile_renderer final
+{
+    SDL_Texture *m_texture;
+    const int m_width, m_height;  // The size of the map, in tiles (and so, of the texture, in pixels)
+    std::array<uint32_t, 256> m_palette;  // The color of every kind of tile, already packed the way the texture wants it
+    uint32_t m_hidden;  // What the tiles that can't be seen are drawn as, instead of their own color
+
+    // The dirty area, as the first and last tile in it on both axes. It's empty when x1 > x2
+    int m_dirtyX1, m_dirtyY1, m_dirtyX2, m_dirtyY2;
+
+    static uint32_t pack(SDL_Color color);  // Packs a color into an ARGB8888 pixel
+
+public:
+    tile_renderer(SDL_Renderer *renderer, int width, int height);  // Makes the texture of a map of the given size. Every tile starts off dirty
+    tile_renderer(const tile_renderer &) = delete;  // We don't allow copying it, it owns the texture
+    ~tile_renderer();
+
+    void set_color(uint8_t tile, SDL_Color color);  // Sets the color that a kind of tile is drawn with (all of them start off black)
+    void set_hidden_color(SDL_Color color);  // Sets the color that the tiles that can't be seen are drawn with (black, to begin with)
+    void mark_dirty(int x1, int y1, int x2, int y2);  // Tells that the tiles in between the two corners (inclusive) changed. Anything off the map is ignored
+    void mark_all_dirty();
+
+    // Writes the dirty tiles into the texture, and clears the dirty area. tileAt(x, y) gives the tile at a position (x and y are always on the map)
+    template<typename TileAt>
+    void upload(TileAt &&tileAt);
+    // The same, but only the tiles that visibleAt(x, y) says can be seen are drawn as themselves. The rest are all drawn in the hidden color, so what's
+    // on them never makes it to the screen. Whenever what's visible changes, the tiles that it changed for have to be marked dirty
+    template<typename TileAt, typename VisibleAt>
+    void upload(TileAt &&tileAt, VisibleAt &&visibleAt);
+
+    void draw(render_queue &queue, int layer, const SDL_FRect &dst) const;  // Draws the whole map, stretched over dst
+    int width() const;
+    int height() const;
+};
+
+template<typename TileAt>
+void tile_renderer::upload(TileAt &&tileAt)
+{
+    upload(tileAt, [](int, int) { return true; });
+}
+
+template<typename TileAt, typename VisibleAt>
+void tile_renderer::upload(TileAt &&tileAt, VisibleAt &&visibleAt)
+{
+    if (m_dirtyX1 > m_dirtyX2)
+        return;
+
+    // Only the dirty area is locked, so the driver only has to send that much to the GPU
+    SDL_Rect area = { m_dirtyX1, m_dirtyY1, m_dirtyX2 - m_dirtyX1 + 1, m_dirtyY2 - m_dirtyY1 + 1 };
+    void *pixels;
+    int pitch;
+    sdlCall(SDL_LockTexture)(m_texture, &area, &pixels, &pitch);
+    for (int y = 0; y < area.h; ++y) {
+        // The pitch is in bytes, and the rows can have padding at the end, so each row is found from the start
+        uint32_t *row = (uint32_t*)((uint8_t*)pixels + y * pitch);
+        for (int x = 0; x < area.w; ++x)
+            row[x] = visibleAt(area.x + x, area.y + y) ? m_palette[(uint8_t)tileAt(area.x + x, area.y + y)] : m_hidden;
+    }
+    sdlCall(SDL_UnlockTexture)(m_texture);
+
+    m_dirtyX1 = m_width;
+    m_dirtyY1 = m_height;
+    m_dirtyX2 = m_dirtyY2 = -1;
+}
+
+#endif  // GAMES_DUNGEON_TILE_RENDERER_HPP
@@ -0,0 +1,205 @@
+#include "tilemap.hpp"
+
+#include <stdexcept>  // std::invalid_argument
+#include <algorithm>  // std::min, std::max, std::swap
+#include <cstring>    // std::memset, std::memcpy
+
+tilemap::tilemap(int width, int height)
+    : m_width{width}, m_height{height},
+    m_chunksX{(width + CHUNK_MASK) >> CHUNK_SHIFT}, m_chunksY{(height + CHUNK_MASK) >> CHUNK_SHIFT}
+{
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("a tilemap has to be at least 1x1");
+    m_directory.assign((std::size_t)m_chunksX * m_chunksY, NULL);
+}
+
+int tilemap::width() const
+{
+    return m_width;
+}
+
+int tilemap::height() const
+{
+    return m_height;
+}
+
+bool tilemap::in_bounds(int x, int y) const
+{
+    return x >= 0 && y >= 0 && x < m_width && y < m_height;
+}
+
+tilemap::chunk *tilemap::allocate_chunk()
+{
+    if (m_freeChunks.empty()) {
+        // Out of chunks, so a whole new page of them is made. They go into the free list backwards, so that they're handed out in order
+        m_pages.push_back(std::make_unique<chunk[]>(CHUNKS_PER_PAGE));
+        chunk *page = m_pages.back().get();
+        for (int i = CHUNKS_PER_PAGE - 1; i >= 0; --i)
+            m_freeChunks.push_back(&page[i]);
+    }
+    chunk *c = m_freeChunks.back();
+    m_freeChunks.pop_back();
+    c->tiles.fill(0);
+    c->filled = 0;
+    c->reserved = false;
+    c->rowFilled.fill(0);
+    ++m_resident;
+    return c;
+}
+
+void tilemap::release_chunk(int chunkX, int chunkY)
+{
+    chunk *&c = m_directory[chunkY * m_chunksX + chunkX];
+    m_freeChunks.push_back(c);
+    c = NULL;
+    --m_resident;
+}
+
+void tilemap::set(int x, int y, uint8_t tile)
+{
+    const int cx = x >> CHUNK_SHIFT, cy = y >> CHUNK_SHIFT;
+    chunk *&c = m_directory[cy * m_chunksX + cx];
+    if (!c) {
+        // Emptying a tile that's already empty needn't make a chunk
+        if (tile == 0)
+            return;
+        c = allocate_chunk();
+    }
+
+    uint8_t &slot = c->tiles[(y & CHUNK_MASK) * CHUNK_SIZE + (x & CHUNK_MASK)];
+    c->filled += (tile != 0) - (slot != 0);
+    slot = tile;
+    const uint32_t bit = 1u << (x & CHUNK_MASK);
+    uint32_t &rowFilled = c->rowFilled[y & CHUNK_MASK];
+    rowFilled = tile != 0 ? rowFilled | bit : rowFilled & ~bit;
+    if (c->filled == 0 && !c->reserved)
+        release_chunk(cx, cy);
+}
+
+// Counts the bits that are set, adding them up in pairs, then in groups of 4, then all of them at once with a multiplication. std::popcount() calls a
+// function for this when the compiler can't use the CPU's own instruction, which it can't without being told which CPUs the game will run on
+static int count_bits(uint32_t bits)
+{
+    bits = bits - ((bits >> 1) & 0x55555555);
+    bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+    return ((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101 >> 24;
+}
+
+void tilemap::fill_rect(int x1, int y1, int x2, int y2, uint8_t tile)
+{
+    if (x1 > x2)
+        std::swap(x1, x2);
+    if (y1 > y2)
+        std::swap(y1, y2);
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, m_width - 1);
+    y2 = std::min(y2, m_height - 1);
+    if (x1 > x2 || y1 > y2)
+        return;
+
+    for (int cx = x1 >> CHUNK_SHIFT; cx <= x2 >> CHUNK_SHIFT; ++cx) {
+        // The part of every row that's in this column of chunks
+        const int start = std::max(x1, cx << CHUNK_SHIFT) & CHUNK_MASK, end = std::min(x2, (cx << CHUNK_SHIFT) + CHUNK_MASK) & CHUNK_MASK;
+        const int length = end - start + 1, filledAfter = tile != 0 ? length : 0;
+        const uint32_t spanBits = (~0u << start) & (~0u >> (CHUNK_MASK - end));
+
+        // Every chunk is looked up once, and its filled count is only changed once, after all of its rows are done
+        for (int cy = y1 >> CHUNK_SHIFT; cy <= y2 >> CHUNK_SHIFT; ++cy) {
+            // The pointer is copied out of the directory: the compiler can't tell that writing tiles doesn't change it, so it would be read again
+            // after every row otherwise
+            chunk *c = m_directory[cy * m_chunksX + cx];
+            if (!c) {
+                if (tile == 0)
+                    continue;
+                c = m_directory[cy * m_chunksX + cx] = allocate_chunk();
+            }
+
+            const int top = std::max(y1, cy << CHUNK_SHIFT) & CHUNK_MASK, bottom = std::min(y2, (cy << CHUNK_SHIFT) + CHUNK_MASK) & CHUNK_MASK;
+            // If the chunk is all empty (a new or reserved one) or all filled, it's known how many of the tiles were filled before without looking at
+            // the rows. Otherwise, the bits of every row tell -- the tiles themselves never have to be counted
+            int wasFilled = 0;
+            if (c->filled == CHUNK_SIZE * CHUNK_SIZE)
+                wasFilled = length * (bottom - top + 1);
+            else if (c->filled != 0)
+                for (int y = top; y <= bottom; ++y)
+                    wasFilled += count_bits(c->rowFilled[y] & spanBits);
+
+            for (int y = top; y <= bottom; ++y) {
+                // A whole row is a memset of a fixed size, which the compiler turns into a couple of stores
+                if (length == CHUNK_SIZE)
+                    std::memset(&c->tiles[y * CHUNK_SIZE], tile, CHUNK_SIZE);
+                else
+                    std::memset(&c->tiles[y * CHUNK_SIZE + start], tile, length);
+                c->rowFilled[y] = tile != 0 ? c->rowFilled[y] | spanBits : c->rowFilled[y] & ~spanBits;
+            }
+            c->filled += filledAfter * (bottom - top + 1) - wasFilled;
+            if (c->filled == 0 && !c->reserved)
+                release_chunk(cx, cy);
+        }
+    }
+}
+
+void tilemap::fill_column(int x, int y1, int y2, uint8_t tile)
+{
+    if (y1 > y2)
+        std::swap(y1, y2);
+    y1 = std::max(y1, 0);
+    y2 = std::min(y2, m_height - 1);
+    if (x < 0 || x >= m_width || y1 > y2)
+        return;
+
+    const int cx = x >> CHUNK_SHIFT;
+    for (int cy = y1 >> CHUNK_SHIFT; cy <= y2 >> CHUNK_SHIFT; ++cy) {
+        chunk *c = m_directory[cy * m_chunksX + cx];  // Copied out of the directory, like in fill_rect()
+        if (!c) {
+            if (tile == 0)
+                continue;
+            c = m_directory[cy * m_chunksX + cx] = allocate_chunk();
+        }
+
+        // Going down the column is a step of a whole row of the chunk at a time. The rows' bits tell which of the tiles were filled before
+        const int top = std::max(y1, cy << CHUNK_SHIFT) & CHUNK_MASK, bottom = std::min(y2, (cy << CHUNK_SHIFT) + CHUNK_MASK) & CHUNK_MASK;
+        const int column = x & CHUNK_MASK;
+        uint8_t *slot = &c->tiles[top * CHUNK_SIZE + column];
+        int wasFilled = 0;
+        for (int y = top; y <= bottom; ++y, slot += CHUNK_SIZE) {
+            *slot = tile;
+            const uint32_t filled = c->rowFilled[y];
+            wasFilled += filled >> column & 1;
+            c->rowFilled[y] = tile != 0 ? filled | 1u << column : filled & ~(1u << column);
+        }
+        c->filled += (tile != 0 ? bottom - top + 1 : 0) - wasFilled;
+        if (c->filled == 0 && !c->reserved)
+            release_chunk(cx, cy);
+    }
+}
+
+void tilemap::reserve(int x1, int y1, int x2, int y2)
+{
+    for (int cy = y1 >> CHUNK_SHIFT; cy <= y2 >> CHUNK_SHIFT; ++cy)
+        for (int cx = x1 >> CHUNK_SHIFT; cx <= x2 >> CHUNK_SHIFT; ++cx) {
+            chunk *&c = m_directory[cy * m_chunksX + cx];
+            if (!c)
+                c = allocate_chunk();
+            c->reserved = true;
+        }
+}
+
+void tilemap::clear()
+{
+    for (int cy = 0; cy < m_chunksY; ++cy)
+        for (int cx = 0; cx < m_chunksX; ++cx)
+            if (m_directory[cy * m_chunksX + cx])
+                release_chunk(cx, cy);
+}
+
+std::size_t tilemap::resident_chunks() const
+{
+    return m_resident;
+}
+
+std::size_t tilemap::memory_used() const
+{
+    return m_directory.size() * sizeof(chunk*) + m_pages.size() * CHUNKS_PER_PAGE * sizeof(chunk);
+}
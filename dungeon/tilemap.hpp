@@ -0,0 +1,88 @@
+#ifndef GAMES_DUNGEON_TILEMAP_HPP
+#define GAMES_DUNGEON_TILEMAP_HPP
+
+#include <array>    // std::array
+#include <vector>   // std::vector
+#include <memory>   // std::unique_ptr
+#include <cstdint>  // uint8_t, uint32_t
+#include <cstddef>  // std::size_t
+
+// A map of tiles (one byte each, 0 meaning empty), split into square chunks of CHUNK_SIZE x CHUNK_SIZE tiles. A chunk only takes up memory once something
+// is put into it, and goes back to the pool once it's empty again -- a dungeon is mostly solid rock, so a map of millions of tiles only needs a few of
+// its chunks at any time. Finding a tile is still O(1): its chunk is looked up in a directory (one pointer per chunk, NULL for empty ones).
+class tilemap final
+{
+public:
+    static constexpr int CHUNK_SHIFT = 5;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;  // 32 tiles on a side
+    static constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+
+    struct chunk
+    {
+        std::array<uint8_t, CHUNK_SIZE * CHUNK_SIZE> tiles;  // Row by row
+        int filled;  // How many of the tiles aren't empty. Once it drops to 0, the chunk is given back to the pool (unless it's reserved)
+        bool reserved;  // Whether reserve() allocated it (or asked for it). Then it's only given back to the pool by clear()
+        // Which of the tiles of every row aren't empty, bit x for the tile at x. Filling a part of a row can tell how many of its tiles were filled before
+        // from these, without having to look at the tiles themselves
+        std::array<uint32_t, CHUNK_SIZE> rowFilled;
+        static_assert(CHUNK_SIZE <= 32, "a row's bits have to fit into a uint32_t");
+    };
+
+private:
+    const int m_width, m_height;  // In tiles
+    const int m_chunksX, m_chunksY;  // In chunks (the chunks on the right and bottom edges can stick out of the map)
+    std::vector<chunk*> m_directory;  // Every chunk of the map, row by row. NULL for the empty ones
+
+    // The chunks are allocated a page at a time, and never freed until the map is. A chunk that's no longer needed goes into the free list, so that
+    // the next chunk that's needed can reuse it
+    static constexpr int CHUNKS_PER_PAGE = 64;
+    std::vector<std::unique_ptr<chunk[]>> m_pages;
+    std::vector<chunk*> m_freeChunks;
+    std::size_t m_resident = 0;  // How many chunks are in use
+
+    chunk *allocate_chunk();  // Gives a chunk full of empty tiles
+    void release_chunk(int chunkX, int chunkY);
+
+public:
+    tilemap(int width, int height);  // Makes an empty map of the given size (in tiles). No chunks are allocated yet
+    tilemap(const tilemap &) = delete;  // We don't allow copying it, it's likely big
+
+    int width() const;
+    int height() const;
+    bool in_bounds(int x, int y) const;
+
+    // Gives the tile at a position, which has to be on the map
+    uint8_t at(int x, int y) const
+    {
+        const chunk *c = m_directory[(y >> CHUNK_SHIFT) * m_chunksX + (x >> CHUNK_SHIFT)];
+        return c ? c->tiles[(y & CHUNK_MASK) * CHUNK_SIZE + (x & CHUNK_MASK)] : 0;
+    }
+    void set(int x, int y, uint8_t tile);  // Changes the tile at a position, which has to be on the map
+    // Sets every tile in between two corners (inclusive, in any order). Anything off the map is cut off. It goes a chunk at a time, with a memset per row
+    // of the chunk, so it's a lot quicker than set() on every tile. Like set(), it only touches the chunks it writes into (if they're allocated, and tile
+    // isn't 0)
+    void fill_rect(int x1, int y1, int x2, int y2, uint8_t tile);
+    void fill_span(int x1, int x2, int y, uint8_t tile) { fill_rect(x1, y, x2, y, tile); }  // Sets every tile from (x1, y) to (x2, y)
+    void fill_column(int x, int y1, int y2, uint8_t tile);  // Sets every tile from (x, y1) to (x, y2), a chunk at a time
+    // Allocates the chunks covering a rectangle (corners inclusive, on the map) up front, even though they're empty. Setting a tile in such a chunk then
+    // only touches that chunk (0 too: a reserved chunk stays allocated until clear(), even once it's empty), so it's fine to do from several threads at
+    // once, as long as no two of them write into the same chunk
+    void reserve(int x1, int y1, int x2, int y2);
+    void clear();  // Empties the whole map, giving every chunk back to the pool
+
+    // Calls visit(chunkX, chunkY, chunk) for every chunk that's in use, row by row. The tile at (x, y) of the chunk is at (chunkX * CHUNK_SIZE + x,
+    // chunkY * CHUNK_SIZE + y) on the map. Empty chunks are skipped, everything in them is 0
+    template<typename F>
+    void for_each_chunk(F &&visit) const
+    {
+        for (int cy = 0; cy < m_chunksY; ++cy)
+            for (int cx = 0; cx < m_chunksX; ++cx)
+                if (const chunk *c = m_directory[cy * m_chunksX + cx])
+                    visit(cx, cy, *c);
+    }
+
+    std::size_t resident_chunks() const;  // How many chunks are in use
+    std::size_t memory_used() const;  // Roughly how many bytes the map takes up (the directory and every allocated chunk, in use or not)
+};
+
+#endif  // GAMES_DUNGEON_TILEMAP_HPP
@@ -0,0 +1,61 @@
+#ifndef GAMES_EVENT_QUEUE_HPP
+#define GAMES_EVENT_QUEUE_HPP
+
+#include <cstddef>  // std::size_t
+#include <cstdint>  // uint64_t
+
+// A first-in first-out queue of up to Capacity events, for the parts of a game to send messages to each other. The events are kept in a plain array
+// inside the object (a "ring buffer"), so pushing and popping never allocates. Unlike SDL_PushEvent, there's no lock and no global event type to register,
+// every game (or headless world) has its own queue, and the events are handled whenever the owner decides to drain it -- not on the next frame.
+// Events are pushed in the middle of a game's update, so a full queue doesn't throw (that would leave the update half done): the new event is dropped,
+// and counted, so that a Capacity that's too small shows up in the stats.
+template<typename Event, std::size_t Capacity>
+class event_queue
+{
+    Event m_events[Capacity];
+    std::size_t m_first = 0;  // The index of the oldest event
+    std::size_t m_size = 0;  // How many events are queued
+    uint64_t m_dropped = 0;  // How many events didn't fit, ever
+
+public:
+    // Adds an event to the end of the queue. If the queue is full, the event is dropped instead, and false is returned
+    bool push(const Event &event)
+    {
+        if (m_size == Capacity) {
+            ++m_dropped;
+            return false;
+        }
+        m_events[(m_first + m_size) % Capacity] = event;
+        ++m_size;
+        return true;
+    }
+
+    // Calls handle(event) for every queued event, oldest first, emptying the queue. handle may push more events, they're handled in the same drain
+    void drain(auto &&handle)
+    {
+        while (m_size > 0) {
+            // Copied out first, so that the slot can be reused if handle pushes a new event
+            Event event = m_events[m_first];
+            m_first = (m_first + 1) % Capacity;
+            --m_size;
+            handle(event);
+        }
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    uint64_t dropped() const
+    {
+        return m_dropped;
+    }
+};
+
+#endif  // GAMES_EVENT_QUEUE_HPP
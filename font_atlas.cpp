@@ -0,0 +1,79 @@
+#include "font_atlas.hpp"
+#include "utils.hpp"
+
+font_atlas::font_atlas(SDL_Renderer *renderer, TTF_Font *font)
+    : m_renderer{renderer}, m_height{sdlCall(TTF_FontHeight)(font)}
+{
+    // Render every glyph first, so that we know how big the atlas has to be. They're rendered in white, with antialiasing (that's what "Blended" means)
+    const int count = LAST_CHAR - FIRST_CHAR + 1;
+    SDL_Surface *surfaces[count];
+    for (int i = 0; i < count; ++i)
+        surfaces[i] = sdlCall(TTF_RenderGlyph_Blended)(font, (Uint16)(FIRST_CHAR + i), SDL_Color{ 255, 255, 255, 255 });
+
+    // Lay the glyphs out in rows, left to right, with a pixel of space around each one so that they don't bleed into each other when scaled
+    const int ATLAS_WIDTH = 512;
+    int x = 1, y = 1;
+    for (int i = 0; i < count; ++i) {
+        if (x + surfaces[i]->w + 1 > ATLAS_WIDTH) {
+            x = 1;
+            y += m_height + 1;
+        }
+        glyph &g = m_glyphs[(int)FIRST_CHAR + i];
+        g.src = { x, y, surfaces[i]->w, surfaces[i]->h };
+        sdlCall(TTF_GlyphMetrics)(font, (Uint16)(FIRST_CHAR + i), NULL, NULL, NULL, NULL, &g.advance);
+        x += surfaces[i]->w + 1;
+    }
+    m_texWidth = ATLAS_WIDTH;
+    m_texHeight = y + m_height + 1;
+
+    // Copy all of them into one surface. The blending is turned off, so that the glyphs' alpha is copied as is, instead of being blended onto the
+    // (transparent) atlas
+    SDL_Surface *atlas = sdlCall(SDL_CreateRGBSurfaceWithFormat)(0, m_texWidth, m_texHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    for (int i = 0; i < count; ++i) {
+        SDL_Rect dst = m_glyphs[(int)FIRST_CHAR + i].src;
+        sdlCall(SDL_SetSurfaceBlendMode)(surfaces[i], SDL_BLENDMODE_NONE);
+        sdlCall(SDL_BlitSurface)(surfaces[i], NULL, atlas, &dst);
+        sdlCall(SDL_FreeSurface)(surfaces[i]);
+    }
+
+    // And upload it, once
+    m_texture = sdlCall(SDL_CreateTextureFromSurface)(renderer, atlas);
+    sdlCall(SDL_FreeSurface)(atlas);
+    sdlCall(SDL_SetTextureBlendMode)(m_texture, SDL_BLENDMODE_BLEND);
+}
+
+font_atlas::~font_atlas()
+{
+    sdlCall(SDL_DestroyTexture)(m_texture);
+}
+
+const font_atlas::glyph &font_atlas::glyph_for(char c) const
+{
+    if (c < FIRST_CHAR || c > LAST_CHAR)
+        c = '?';
+    return m_glyphs[(int)c];
+}
+
+int font_atlas::measure(std::string_view text) const
+{
+    int width = 0;
+    for (char c : text)
+        width += glyph_for(c).advance;
+    return width;
+}
+
+int font_atlas::height() const
+{
+    return m_height;
+}
+
+void font_atlas::draw(render_queue &queue, int layer, std::string_view text, int x, int y, SDL_Color color) const
+{
+    // Every character is a quad, the color multiplies the (white) glyph
+    float penX = x;
+    for (char c : text) {
+        const glyph &g = glyph_for(c);
+        queue.copy(layer, m_texture, m_texWidth, m_texHeight, g.src, { penX, (float)y, (float)g.src.w, (float)g.src.h }, color);
+        penX += g.advance;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef GAMES_FONT_ATLAS_HPP
+#define GAMES_FONT_ATLAS_HPP
+
+#include <string_view>  // std::string_view
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "render_queue.hpp"
+
+// A font, rendered ahead of time. Every printable ASCII character is rasterized once, when the atlas is made, and packed into a single texture (the
+// "atlas"). Drawing a string then just draws a rectangle of that texture per character, and the render queue batches all of them into one
+// SDL_RenderGeometry call -- so text can change every frame without anything being rasterized or uploaded to the GPU.
+// Kerning is ignored (Terminus, the font the games use, is monospaced, so it doesn't have any).
+class font_atlas
+{
+    // Where a character is in the atlas, and how far it moves the pen
+    struct glyph
+    {
+        SDL_Rect src;
+        int advance;
+    };
+
+    SDL_Renderer *const m_renderer;
+    SDL_Texture *m_texture;  // The atlas itself. The glyphs are white, and get their color from the vertices
+    int m_texWidth, m_texHeight;
+    int m_height;  // The height of a line of text
+    glyph m_glyphs[128];  // Indexed by the character. Only the printable ones (' ' to '~') are filled in, the others are drawn as '?'
+
+    const glyph &glyph_for(char c) const;
+
+public:
+    static constexpr char FIRST_CHAR = ' ', LAST_CHAR = '~';
+
+    font_atlas(SDL_Renderer *renderer, TTF_Font *font);  // Rasterizes every glyph of the font, and uploads the atlas
+    font_atlas(const font_atlas &) = delete;  // We don't allow copying it, it owns the texture
+    ~font_atlas();
+
+    int measure(std::string_view text) const;  // The width of the text, in pixels
+    int height() const;  // The height of a line of text, in pixels
+    void draw(render_queue &queue, int layer, std::string_view text, int x, int y, SDL_Color color) const;  // Draws the text with its top left corner at (x, y)
+};
+
+#endif  // GAMES_FONT_ATLAS_HPP
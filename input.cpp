@@ -0,0 +1,32 @@
+#include "input.hpp"
+#include "utils.hpp"
+
+input_state input_state::from_keyboard()
+{
+    // SDL keeps an array with a byte per scancode, which is up to date as of the last time events were polled
+    int count;
+    const Uint8 *keys = sdlCallUnchecked(SDL_GetKeyboardState)(&count);
+
+    input_state result;
+    for (int key = 0; key < count && key < SDL_NUM_SCANCODES; ++key)
+        result.m_held[key] = keys[key] != 0;
+    return result;
+}
+
+bool input_state::held(SDL_Scancode key) const
+{
+    return m_held[key];
+}
+
+void input_state::set(SDL_Scancode key, bool held)
+{
+    m_held[key] = held;
+}
+
+void input_state::on_event(const SDL_Event &event)
+{
+    if (event.type == SDL_KEYDOWN)
+        set(event.key.keysym.scancode, true);
+    else if (event.type == SDL_KEYUP)
+        set(event.key.keysym.scancode, false);
+}
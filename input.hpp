@@ -0,0 +1,25 @@
+#ifndef GAMES_INPUT_HPP
+#define GAMES_INPUT_HPP
+
+#include <bitset>  // std::bitset
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+
+// A snapshot of the keyboard: one bit per key (scancode), set if the key is held down. It's taken once per update and handed to whatever needs it, so
+// checking a key is just reading a bit. It's a small, plain value (64 bytes), so it can be freely copied -- recorded, replayed, or made up by a bot.
+class input_state
+{
+    std::bitset<SDL_NUM_SCANCODES> m_held;  // Which keys are held down
+
+public:
+    static input_state from_keyboard();  // Takes a snapshot of the current state of the real keyboard
+
+    bool held(SDL_Scancode key) const;  // Checks if the key is held down
+    void set(SDL_Scancode key, bool held);  // Changes whether the key is held down
+    void on_event(const SDL_Event &event);  // Updates the snapshot according to an SDL_KEYDOWN or SDL_KEYUP event (other events are ignored)
+
+    bool operator==(const input_state &other) const = default;
+};
+
+#endif  // GAMES_INPUT_HPP
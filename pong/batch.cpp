@@ -0,0 +1,49 @@
+#include "batch.hpp"
+#include <algorithm>  // std::max
+#include <atomic>  // std::atomic
+#include <chrono>  // std::chrono::steady_clock
+#include <thread>  // std::thread
+
+uint64_t batch_stats::total_ticks() const
+{
+    uint64_t total = 0;
+    for (const auto &match : matches)
+        total += match.ticks;
+    return total;
+}
+
+double batch_stats::ticks_per_second() const
+{
+    return seconds > 0 ? total_ticks() / seconds : 0;
+}
+
+batch_stats run_batch(unsigned matches, bool hockeyMode, uint64_t ticks, float deltaTime, unsigned seed, unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    if (threads > matches)
+        threads = std::max(1u, matches);
+
+    batch_stats result{ std::vector<headless_stats>(matches), threads, 0 };
+
+    // Every thread keeps grabbing the next match that nobody has started yet. The matches don't share anything, and every one writes its results
+    // into its own slot, so there's nothing else to synchronize.
+    std::atomic<unsigned> nextMatch = 0;
+    auto worker = [&]()
+    {
+        for (unsigned i = nextMatch++; i < matches; i = nextMatch++)
+            result.matches[i] = run_headless(hockeyMode, ticks, deltaTime, seed + i);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i)
+        workers.emplace_back(worker);
+    worker();  // The calling thread does its share of work too
+    for (auto &thread : workers)
+        thread.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    result.seconds = elapsed.count();
+    return result;
+}
@@ -0,0 +1,27 @@
+#ifndef GAMES_PONG_BATCH_HPP
+#define GAMES_PONG_BATCH_HPP
+
+#include <cstdint>  // uint64_t
+#include <vector>   // std::vector
+
+#include "headless.hpp"
+
+// Running many independent headless games at once, spread over all the CPU cores. Every match is simulated by run_headless, so the per-match
+// statistics are the same as for a single headless run.
+
+// The results of a batch of matches
+struct batch_stats
+{
+    std::vector<headless_stats> matches;  // The results of every match, in order
+    unsigned threads;  // How many threads the matches were run on
+    double seconds;  // How much real time the whole batch took
+
+    uint64_t total_ticks() const;  // How many updates were done in total, across all matches
+    double ticks_per_second() const;  // How many updates were done per second of real time, across all matches
+};
+
+// Runs `matches` matches of `ticks` updates each, on `threads` threads (0 means one per CPU core). Match number i uses seed + i as its seed, so
+// the results don't depend on the amount of threads.
+batch_stats run_batch(unsigned matches, bool hockeyMode, uint64_t ticks, float deltaTime, unsigned seed, unsigned threads = 0);
+
+#endif  // GAMES_PONG_BATCH_HPP
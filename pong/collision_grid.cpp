@@ -0,0 +1,42 @@
+#include "collision_grid.hpp"
+
+collision_grid::collision_grid(int width, int height, int cellSize)
+    : m_cellSize{cellSize}, m_columns{(width + cellSize - 1) / cellSize}, m_rows{(height + cellSize - 1) / cellSize}
+{
+}
+
+void collision_grid::cell_range(const SDL_Rect &rect, int margin, int &x1, int &y1, int &x2, int &y2) const
+{
+    // A helper to turn a pixel coordinate into a cell coordinate, clamped to the grid. Dividing negative numbers rounds towards zero, but
+    // those get clamped to 0 anyway.
+    auto toCell = [this](int pixel, int count)
+    {
+        int cell = pixel / m_cellSize;
+        return cell < 0 ? 0 : (cell >= count ? count - 1 : cell);
+    };
+    x1 = toCell(rect.x - margin, m_columns);
+    y1 = toCell(rect.y - margin, m_rows);
+    x2 = toCell(rect.x + rect.w + margin, m_columns);
+    y2 = toCell(rect.y + rect.h + margin, m_rows);
+}
+
+void collision_grid::rebuild(const body_components &bodies, int margin)
+{
+    m_margin = margin;
+    m_visitedBy.resize(bodies.size());
+
+    // File every entity that can be collided with into every cell it touches
+    m_entries.clear();
+    for (entity e = 0; e < bodies.size(); ++e) {
+        if (!bodies.layers[e])
+            continue;
+        int x1, y1, x2, y2;
+        cell_range(bodies.bounding_box(e), 0, x1, y1, x2, y2);
+        for (int y = y1; y <= y2; ++y)
+            for (int x = x1; x <= x2; ++x)
+                m_entries.push_back({ (unsigned)(y * m_columns + x), e, bodies.layers[e] });
+    }
+
+    // Then sort them by cell, so that queries can find them
+    std::sort(m_entries.begin(), m_entries.end());
+}
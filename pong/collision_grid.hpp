@@ -0,0 +1,87 @@
+#ifndef GAMES_PONG_COLLISION_GRID_HPP
+#define GAMES_PONG_COLLISION_GRID_HPP
+
+#include <vector>  // std::vector
+#include <cstdint>  // uint32_t
+#include <algorithm>  // std::fill, std::lower_bound, std::sort
+
+#include "components.hpp"
+
+// A uniform grid over the game area, used to quickly find the entities near a given rectangle (the "broad phase" of collision detection). Every
+// entity is filed into each cell that its bounding box touches, so asking what's near something only needs to look at a handful of cells instead of
+// every entity in the game. The grid is rebuilt from scratch once per update; after the first few updates, that doesn't allocate any memory.
+// The cost of a rebuild depends on the amount of entities, not on the amount of cells.
+class collision_grid final
+{
+    const int m_cellSize;  // The width and height of a single cell, in pixels
+    const int m_columns, m_rows;  // How many cells there are
+    int m_margin = 0;  // How far (in pixels) entities are allowed to move in between rebuilding the grid and querying it (see rebuild)
+
+    // A single entity filed into a single cell. The entity's collision layers are copied in, so that queries can skip the entities they aren't
+    // interested in without looking anything up.
+    struct cell_entry
+    {
+        unsigned cell;
+        entity id;
+        uint32_t layers;
+
+        // Entries are ordered by cell, and then by entity, so that queries always visit entities in the same order
+        bool operator<(const cell_entry &other) const { return cell != other.cell ? cell < other.cell : id < other.id; }
+    };
+
+    // The contents of all the cells, sorted by cell. A cell's number is y * m_columns + x, so the cells of a row that a query touches are next to each
+    // other in this list. Empty cells take up no space at all.
+    std::vector<cell_entry> m_entries;
+
+    // An entity can be in many cells, but a query should only report it once. Each query gets a new number, and each entity remembers the number of
+    // the last query that reported it.
+    std::vector<unsigned> m_visitedBy;
+    unsigned m_queryID = 0;
+
+    // Figures out the range of cells (inclusive) that a rectangle, grown by `margin` on every side, touches. It's clamped to the grid, so entities
+    // that are off-screen end up in the border cells.
+    void cell_range(const SDL_Rect &rect, int margin, int &x1, int &y1, int &x2, int &y2) const;
+
+public:
+    collision_grid(int width, int height, int cellSize);  // Creates a grid covering width x height pixels
+    collision_grid(const collision_grid &) = delete;  // We don't allow copying it
+
+    // Files every entity that is on any collision layer into the cells it touches. Until the next rebuild, the entities may move up to margin pixels
+    // away from where they were filed, and queries still find them (they look that much further around)
+    void rebuild(const body_components &bodies, int margin);
+
+    // Calls visit(entity) once for every entity on any of the given collision layers that might touch the given rectangle. visit can return true to stop
+    // the search early, in which case query returns true as well.
+    template<typename F>
+    bool query(const SDL_Rect &area, uint32_t layers, F &&visit)
+    {
+        // Start a new query, making sure that the IDs don't wrap around into ones that were used already
+        if (++m_queryID == 0) {
+            std::fill(m_visitedBy.begin(), m_visitedBy.end(), 0);
+            m_queryID = 1;
+        }
+
+        int x1, y1, x2, y2;
+        cell_range(area, m_margin, x1, y1, x2, y2);
+        for (int y = y1; y <= y2; ++y) {
+            // Find where the first cell of this row starts in the list, and go through the entries until we're past the last cell
+            const unsigned lastCell = y * m_columns + x2;
+            auto iter = std::lower_bound(m_entries.begin(), m_entries.end(), cell_entry{ (unsigned)(y * m_columns + x1), 0, 0 });
+            for (; iter != m_entries.end() && iter->cell <= lastCell; ++iter) {
+                // Skip entities on other layers
+                if (!(iter->layers & layers))
+                    continue;
+                entity e = iter->id;
+                // Skip entities that this query already reported
+                if (m_visitedBy[e] == m_queryID)
+                    continue;
+                m_visitedBy[e] = m_queryID;
+                if (visit(e))
+                    return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif  // GAMES_PONG_COLLISION_GRID_HPP
@@ -0,0 +1,31 @@
+#include "components.hpp"
+
+entity body_components::add(entity_kind newKind, int newX, int newY, int newWidth, int newHeight, const SDL_Rect &newSprite, uint32_t newLayers, uint32_t newCollidesWith)
+{
+    // Every array grows by one, so the new entity's number is the old size
+    kind.push_back(newKind);
+    x.push_back(newX);
+    y.push_back(newY);
+    prevX.push_back(newX);
+    prevY.push_back(newY);
+    startX.push_back(newX);
+    startY.push_back(newY);
+    velX.push_back(0.0f);
+    velY.push_back(0.0f);
+    width.push_back(newWidth);
+    height.push_back(newHeight);
+    sprite.push_back(newSprite);
+    layers.push_back(newLayers);
+    collidesWith.push_back(newCollidesWith);
+    return kind.size() - 1;
+}
+
+unsigned body_components::size() const
+{
+    return kind.size();
+}
+
+SDL_Rect body_components::bounding_box(entity e) const
+{
+    return { (int)x[e], (int)y[e], width[e], height[e] };
+}
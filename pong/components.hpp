@@ -0,0 +1,69 @@
+#ifndef GAMES_PONG_COMPONENTS_HPP
+#define GAMES_PONG_COMPONENTS_HPP
+
+#include <vector>   // std::vector
+#include <cstdint>  // uint8_t, uint32_t
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+
+// The things in a pong game (paddles, balls, goals) are "entities". An entity isn't an object with its own methods, it's just a number -- an index into
+// a set of arrays, each holding one property ("component") of every entity. The game logic lives in "systems", functions that go through those arrays
+// from start to end (see pong_world). Keeping every property in its own contiguous array means that a system only ever touches the memory it needs.
+using entity = unsigned;
+
+// What kind of thing an entity is. This decides which systems act on it.
+enum class entity_kind : uint8_t
+{
+    paddle,  // Moved by the players, the ball bounces off it
+    ball,    // Moves on its own, and bounces off everything
+    goal,    // A black wall the ball bounces off (a hockey goal is two of them, with the hole in between)
+};
+
+// The collision layers. Every entity is on some layers, and collides with the entities on some (other) layers -- both are sets of these bits. The systems
+// only ever ask about the layers they're interested in, so a new kind of entity can take part in collisions just by picking its layers.
+enum collision_layer : uint32_t
+{
+    LAYER_PADDLE = 1 << 0,
+    LAYER_BALL = 1 << 1,
+    LAYER_GOAL = 1 << 2,
+};
+
+// The components that every entity has, stored as a "structure of arrays". Entity e's position is (x[e], y[e]), its size is width[e] x height[e], and so on.
+struct body_components
+{
+    std::vector<entity_kind> kind;
+    std::vector<float> x, y;  // The position of the top left corner
+    std::vector<float> prevX, prevY;  // The position before the last update, used to draw the entity smoothly in between updates
+    std::vector<float> startX, startY;  // Where the entity goes back to when the game is reset
+    std::vector<float> velX, velY;  // How fast the entity is moving, in pixels per second
+    std::vector<int> width, height;  // The size of the entity; it's also its (only) collision area
+    std::vector<SDL_Rect> sprite;  // What the entity looks like -- its part of the sprite atlas (empty if it isn't drawn with a sprite, or when there's no window)
+    std::vector<uint32_t> layers;  // The collision layers the entity is on (0 means it can't be collided with)
+    std::vector<uint32_t> collidesWith;  // The collision layers the entity collides with
+
+    // Adds a new, unmoving entity, and gives back its number
+    entity add(entity_kind kind, int x, int y, int width, int height, const SDL_Rect &sprite, uint32_t layers, uint32_t collidesWith);
+    unsigned size() const;  // Gives the amount of entities
+
+    SDL_Rect bounding_box(entity e) const;  // Gives the area the entity takes up (and collides with)
+};
+
+// The components that only some kinds of entities have. Each is kept in an array of its own, together with the entity it belongs to.
+
+// The controls of a paddle
+struct paddle_component
+{
+    entity id;
+    SDL_Scancode upKey, downKey;  // Which keys move the paddle
+    float speed;  // How fast the paddle moves
+};
+
+// The speed of a ball (it never changes, only the direction does)
+struct ball_component
+{
+    entity id;
+    float speed;
+};
+
+#endif  // GAMES_PONG_COMPONENTS_HPP
@@ -0,0 +1,35 @@
+#include "headless.hpp"
+#include <chrono>  // std::chrono::steady_clock
+
+double headless_stats::ticks_per_second() const
+{
+    return seconds > 0 ? ticks / seconds : 0;
+}
+
+void press_random_keys(const pong_world &world, input_state &input, std::minstd_rand &random)
+{
+    for (SDL_Scancode key : world.control_keys())
+        input.set(key, random() % 2);
+}
+
+headless_stats run_headless(bool hockeyMode, uint64_t ticks, float deltaTime, unsigned seed)
+{
+    // No renderer, no sprites and no font -- the entities know their sizes anyway
+    pong_world world{NULL, NULL, NULL, hockeyMode};
+
+    // The "players" just mash random keys. Every 20 ticks (a third of a second at 60 ticks per second) each key gets pressed or released at random.
+    std::minstd_rand random{seed};
+    input_state input;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t tick = 0; tick < ticks; ++tick) {
+        if (tick % 20 == 0)
+            press_random_keys(world, input, random);
+
+        world.update(deltaTime, input);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    auto [score1, score2] = world.scores().scores();
+    return { ticks, elapsed.count(), ticks * deltaTime, score1, score2, world.rallies(), world.dropped_events() };
+}
@@ -0,0 +1,31 @@
+#ifndef GAMES_PONG_HEADLESS_HPP
+#define GAMES_PONG_HEADLESS_HPP
+
+#include <cstdint>  // uint64_t
+#include <random>   // std::minstd_rand
+
+#include "pong.hpp"
+
+// Running the pong game without a window. The game is stepped with a fixed timestep as fast as the CPU allows, and the paddles are moved
+// by random key presses, so that the ball/paddle physics can be soak-tested and benchmarked. SDL doesn't need to be initialized for this.
+
+// The results of a headless run
+struct headless_stats
+{
+    uint64_t ticks;  // How many times the world was updated
+    double seconds;  // How much real time it took
+    float simulatedSeconds;  // How much game time passed
+    int score1, score2;  // The final score
+    rally_stats rallies;  // Statistics about the rallies
+    uint64_t droppedEvents;  // How many events the world's event queue had no room for
+
+    double ticks_per_second() const;  // How many updates were done per second of real time
+};
+
+// Presses or releases every key that controls a paddle in the world, at random. This is what the "players" of a headless game do every 20 ticks.
+void press_random_keys(const pong_world &world, input_state &input, std::minstd_rand &random);
+
+// Simulates `ticks` updates of a pong (or hockey) game, each advancing it by deltaTime seconds. The seed decides the random key presses.
+headless_stats run_headless(bool hockeyMode, uint64_t ticks, float deltaTime, unsigned seed);
+
+#endif  // GAMES_PONG_HEADLESS_HPP
@@ -1,262 +1,364 @@
 #include "pong.hpp"
 #include <cmath>
+#include <cstdio>
 #include <algorithm>
 
-uint32_t givePointEventType;  // The definition for the extern givePointEventType variable
+// Implementations of scoreboard methods
 
-// An object that represents the hole in which the ball has to go into in hockey mode
-class goal : public object
+// The constructor for a scoreboard object
+scoreboard::scoreboard(const font_atlas *font, int x, int y)
+    : m_font{font}, m_x{x}, m_y{y}
 {
-    const int m_width, m_holeSize;   // Customizable width and hole size, these properties hold those parameters
-public:
-    // The constructor -- it takes the x (no y, as the object spans the whole screen), the width, and the hole size
-    goal(SDL_Renderer *renderer, int x, int width, int holeSize)
-        : object{renderer, NULL, x, 0}, m_width{width}, m_holeSize{holeSize}
-    {
-        // A bit of a hack, we override the texture size to be the size of the bounding box of the goal
-        m_texWidth = width;
-        m_texHeight = SCREEN_HEIGHT;
-    }
+}
 
-    // This function returns a list of axis-aligned bounding boxes for this object
-    virtual std::vector<SDL_Rect> get_collision_areas() const override
-    {
-        // We have 2 bounding boxes -- one for the top part of the goal, and one for the bottom. That way, the ball can go through
-        // the middle
-        return std::vector {
-            SDL_Rect { (int)m_x, (int)m_y, m_width, (SCREEN_HEIGHT - m_holeSize) / 2 },
-            SDL_Rect { (int)m_x, (int)(m_y + (SCREEN_HEIGHT + m_holeSize) / 2), m_width, (SCREEN_HEIGHT - m_holeSize) / 2 }
-        };
+// A function to draw the scoreboard (it's anchored to its center)
+void scoreboard::draw(render_queue &queue, int layer) const
+{
+    // Format the score nicely, into a buffer on the stack (it's drawn every frame, so it shouldn't allocate)
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%d - %d", m_score1, m_score2);
+    std::string_view view{text, (std::size_t)length};
+
+    // Draw the text anchored to the middle
+    m_font->draw(queue, layer, view, m_x - m_font->measure(view) / 2, m_y, { 0, 0, 0, 255 });
+}
+
+// Add a point to a player
+void scoreboard::addPoint(int player)
+{
+    // No need for an array when there's just 2 players. I think. Not sure if this is best practice
+    if (player == 0)
+        ++m_score1;
+    else
+        ++m_score2;
+}
+
+std::tuple<int, int> scoreboard::scores() const
+{
+    return { m_score1, m_score2 };
+}
+
+
+// Implementations of functions for a pong_world object
+
+double rally_stats::average_rally() const
+{
+    return rallies > 0 ? (double)paddleHits / rallies : 0;
+}
+
+pong_world::pong_world(SDL_Renderer *renderer, const sprite_atlas *sprites, const font_atlas *font, bool hockeyMode)
+    : m_renderer{renderer}, m_sprites{sprites}, m_scores{font, SCREEN_WIDTH / 2, 0},
+    // The grid cells are about the size of a paddle's width
+    m_grid{SCREEN_WIDTH, SCREEN_HEIGHT, 64}
+{
+    // The playing field is the whole window (without a renderer, there's no window, so we just assume the default screen size)
+    if (renderer) {
+        sdlCall(SDL_GetRendererOutputSize)(renderer, &m_width, &m_height);
+    } else {
+        m_width = SCREEN_WIDTH;
+        m_height = SCREEN_HEIGHT;
     }
 
-    // We change the drawing logic of a default object. A goal object doesn't have a texture, it just draws black rectangles
-    virtual void draw() const override
+    // Where the sprites are in the atlas (without one, nothing is drawn, so the entities don't get a sprite)
+    SDL_Rect paddleSprite = sprites ? sprites->region("paddle.png") : SDL_Rect{ 0, 0, 0, 0 };
+    SDL_Rect ballSprite = sprites ? sprites->region("ball.png") : SDL_Rect{ 0, 0, 0, 0 };
+
+    // A helper to add a paddle, remembering its controls
+    auto addPaddle = [&](int x, SDL_Scancode upKey, SDL_Scancode downKey)
+    {
+        // Paddles are stopped by goals
+        entity id = m_bodies.add(entity_kind::paddle, x, SCREEN_HEIGHT / 2 - PADDLE_HEIGHT / 2, PADDLE_WIDTH, PADDLE_HEIGHT, paddleSprite, LAYER_PADDLE, LAYER_GOAL);
+        m_paddles.push_back({ id, upKey, downKey, 300.0f });
+        m_controlKeys.push_back(upKey);
+        m_controlKeys.push_back(downKey);
+    };
+    // A helper to add a goal. It's two walls -- one for the top part of the goal, and one for the bottom. That way, the ball can go through the middle
+    auto addGoal = [&](int x, int width, int holeSize)
     {
-        // Set current color to black
-        sdlCall(SDL_SetRenderDrawColor)(m_renderer, 0, 0, 0, 255);
-        // Draw top rectangle
-        SDL_Rect rect = { (int)m_x, (int)m_y, m_width, (SCREEN_HEIGHT - m_holeSize) / 2 };
-        SDL_RenderFillRect(m_renderer, &rect);
-        // Draw bottom rectangle
-        rect.y += (SCREEN_HEIGHT + m_holeSize) / 2;
-        SDL_RenderFillRect(m_renderer, &rect);
+        int wallHeight = (SCREEN_HEIGHT - holeSize) / 2;
+        m_bodies.add(entity_kind::goal, x, 0, width, wallHeight, SDL_Rect{ 0, 0, 0, 0 }, LAYER_GOAL, 0);
+        m_bodies.add(entity_kind::goal, x, (SCREEN_HEIGHT + holeSize) / 2, width, wallHeight, SDL_Rect{ 0, 0, 0, 0 }, LAYER_GOAL, 0);
+    };
+
+    // Add player paddles to the game
+    addPaddle(25, SDL_SCANCODE_Q, SDL_SCANCODE_A);
+    addPaddle(SCREEN_WIDTH - 25 - PADDLE_WIDTH, SDL_SCANCODE_O, SDL_SCANCODE_L);
+
+    if (hockeyMode) {
+        // Add more player paddles to the game
+        addPaddle(250, SDL_SCANCODE_W, SDL_SCANCODE_S);
+        addPaddle(SCREEN_WIDTH - 250 - PADDLE_WIDTH, SDL_SCANCODE_I, SDL_SCANCODE_K);
+        addPaddle(350, SDL_SCANCODE_E, SDL_SCANCODE_D);
+        addPaddle(SCREEN_WIDTH - 350 - PADDLE_WIDTH, SDL_SCANCODE_U, SDL_SCANCODE_J);
+        // Add goals to the game
+        addGoal(0, 64, 320);
+        addGoal(SCREEN_WIDTH - 64, 64, 320);
     }
-};
 
-// Object that represents an in-game paddle
-class paddle : public object {
-    // Which keys are used to control this particular paddle
-    const int m_upKey, m_downKey;
-    const float m_speed;  // Paddle speed parameter
+    // Add ball to the game
+    // The ball bounces off everything
+    entity ballID = m_bodies.add(entity_kind::ball, SCREEN_WIDTH / 2 - BALL_SIZE / 2, SCREEN_HEIGHT / 2 - BALL_SIZE / 2, BALL_SIZE, BALL_SIZE, ballSprite,
+                                 LAYER_BALL, LAYER_PADDLE | LAYER_GOAL | LAYER_BALL);
+    m_balls.push_back({ ballID, 300.0f });
 
-public:
-    // The current vertical speed of the paddle, used to calculate ball deflection angle
-    float m_verticalSpeed = 0.0f;
+    // Get everything moving
+    reset();
+}
 
-    // The constructor. It takes in the starting location of the paddle, its speed, as well as its controls.
-    paddle(SDL_Renderer *renderer, SDL_Texture *tex, int startX, int startY, float speed, int upKey, int downKey)
-        : object{renderer, tex, startX, startY}, m_upKey{upKey}, m_downKey{downKey}, m_speed{speed}
-    {}
+void pong_world::update(float deltaTime, const input_state &input)
+{
+    // Remember where everything was before this update, for drawing
+    m_bodies.prevX = m_bodies.x;
+    m_bodies.prevY = m_bodies.y;
+
+    // Run the systems. The paddles only ever run into goals, which don't move, so the grid from the last update is good enough for them
+    update_paddles(deltaTime, input);
+
+    // Then sort everything into the collision grid, so that the balls can quickly find their neighbors. The paddles are filed where they ended up,
+    // only the balls move after this -- and none of them more than its speed times the update's length, so that's how far the queries look around
+    float fastestBall = 0.0f;
+    for (const ball_component &ball : m_balls)
+        fastestBall = std::max(fastestBall, ball.speed);
+    m_grid.rebuild(m_bodies, (int)ceilf(fastestBall * deltaTime) + 1);
+    update_balls(deltaTime);
+
+    // The events are only handled once everything is updated, resetting the world in the middle of an update would leave it half-reset
+    handle_events();
+}
 
-    // The update function is overriden, as the paddle has behavior that must run each frame.
-    virtual void update(float deltaTime, const std::vector<std::unique_ptr<object>> &others) override
+void pong_world::handle_events()
+{
+    bool scored = false;
+    m_events.drain([&](const pong_event &event)
     {
-        float prevY = m_y;
+        switch (event.type) {
+        case pong_event::goal_scored:
+            // Only one point can be given per update, the first one wins
+            if (scored)
+                break;
+            scored = true;
+
+            // Update the score
+            m_scores.addPoint(event.player);
+
+            // The rally is over
+            ++m_rallies.rallies;
+            if (m_currentRally > m_rallies.longestRally)
+                m_rallies.longestRally = m_currentRally;
+            m_currentRally = 0;
+
+            // And the next one starts from the beginning
+            m_events.push({ pong_event::reset });
+            break;
+
+        case pong_event::paddle_hit:
+            // Keep track of the rallies
+            ++m_currentRally;
+            ++m_rallies.paddleHits;
+            break;
+
+        case pong_event::reset:
+            reset();
+            break;
+        }
+    });
+}
+
+void pong_world::update_paddles(float deltaTime, const input_state &input)
+{
+    for (const paddle_component &paddle : m_paddles) {
+        const entity e = paddle.id;
+        float prevY = m_bodies.y[e];
         float movement = 0.0f;
 
         // Updating the displacement of the paddle based on the keys currently held by the user
-        if (m_keys[m_upKey])
-            movement = -m_speed * deltaTime;
-        if (m_keys[m_downKey])
-            movement = m_speed * deltaTime;
+        if (input.held(paddle.upKey))
+            movement = -paddle.speed * deltaTime;
+        if (input.held(paddle.downKey))
+            movement = paddle.speed * deltaTime;
 
         // Apply the evaluated displacement
-        m_y += movement;
-
-        // For every single object
-        for (auto &other : others) {
-            // If this object is not a goal object, then ignore it
-            goal *goalpost = dynamic_cast<goal*>(other.get());
-            if (!goalpost)
-                continue;
-            // If it is a goal object, then check if we overlap with it
-            if (aabb_overlap_all(get_collision_areas(), goalpost->get_collision_areas()))
-            {
-                // If we do, then cancel our movement
-                m_y -= movement;
-                break;
-            }
-        }
+        m_bodies.y[e] += movement;
+
+        // If we moved into anything we collide with (a goal), then cancel our movement
+        if (for_each_touching(m_bodies.bounding_box(e), m_bodies.collidesWith[e], [e](entity other) { return other != e; }))
+            m_bodies.y[e] -= movement;
 
         // Clamp the Y value
-        if (m_y > m_maxY - m_texHeight)
-            m_y = m_maxY - m_texHeight;
-        if (m_y < 0)
-            m_y = 0;
+        if (m_bodies.y[e] > m_height - m_bodies.height[e])
+            m_bodies.y[e] = m_height - m_bodies.height[e];
+        if (m_bodies.y[e] < 0)
+            m_bodies.y[e] = 0;
 
-        // Figure out our current speed
-        m_verticalSpeed = (m_y - prevY) / deltaTime;
+        // Figure out our current speed, it's used to calculate the ball's deflection angle
+        m_bodies.velY[e] = (m_bodies.y[e] - prevY) / deltaTime;
     }
-};
+}
 
-// An object representing a ball
-class ball : public object
+void pong_world::update_balls(float deltaTime)
 {
-    // The (constant!) speed of the ball
-    const float m_speed;
-    // The current direction vector of the ball
-    float m_dirX, m_dirY;
-
-    // List of objects that we're currently colliding with
-    std::vector<object*> m_collided;
-
-public:
-    // Constructor for the ball; we simply set the starting x and y positions, as well as the constant speed and starting direction
-    ball(SDL_Renderer *renderer, SDL_Texture *tex, int startX, int startY, float speed)
-        : object{renderer, tex, startX, startY}, m_speed{speed}, m_dirX{1.0f}, m_dirY{0.0f}
-    {}
-
-    // Reset requires custom logic for the ball -- we also need to reset its direction
-    virtual void reset() override
-    {
-        object::reset();  // Call the original reset function
-        // Reset the velocity of the ball to its original value
-        m_dirX = 1.0f;
-        m_dirY = 0.0f;
-    }
-
-    // The ball has behavior that must be ran each frame, and so, update is overriden
-    virtual void update(float deltaTime, const std::vector<std::unique_ptr<object>> &others) override
-    {
-        // Move along the velocity vector
-        m_x += m_dirX * m_speed * deltaTime;
-        m_y += m_dirY * m_speed * deltaTime;
-        // For every single object
-        for (auto &obj : others) {
-            // If said object is actually us, then ignore it
-            if (obj.get() == this)
-                continue;
-            // If said object is incapable of collisions, then ignore it (Hack! This should be handled by get_collision_areas() returning an empty vector)
-            if (!obj->can_collide())
-                continue;
-
-            // If the ball overlaps with that object...
-            if (aabb_overlap_all(get_collision_areas(), obj->get_collision_areas())) {
-                // And if the object isn't featured in the list of currently overlapping object...
-                if (std::find(m_collided.begin(), m_collided.end(), obj.get()) == m_collided.end()) {
-                    // ...then add it to that list,
-                    m_collided.push_back(obj.get());
-                    // and undo our X displacement for this frame, while also bouncing,
-                    m_x -= m_dirX * m_speed * deltaTime;
-                    m_dirX = -m_dirX;
-
-                    // and if it's a paddle that we're colliding with (HACK)...
-                    paddle *p = dynamic_cast<paddle*>(obj.get());
-                    if (p != NULL) {
-                        // ...then bounce from paddle. (not physically accurate in the slightest)
-                        m_dirY += p->m_verticalSpeed * 0.003f;
-                        float length = sqrtf(m_dirX * m_dirX + m_dirY * m_dirY);
-                        m_dirX /= length;
-                        m_dirY /= length;
-                    }
-
-                    break;
+    for (const ball_component &ball : m_balls) {
+        const entity e = ball.id;
+        float &x = m_bodies.x[e], &y = m_bodies.y[e];
+        float &velX = m_bodies.velX[e], &velY = m_bodies.velY[e];
+        const int width = m_bodies.width[e], height = m_bodies.height[e];
+
+        // The ball doesn't just jump to its new position and check what it overlaps with -- that would let it go straight through a paddle if it moved
+        // far enough in a single update. Instead, it sweeps its bounding box along the way, and stops at the first thing it would hit. There it bounces,
+        // and continues with the time that's left. A ball squeezed in between a paddle and a wall could bounce forever, so there's a limit on bounces.
+        float timeLeft = deltaTime;
+        for (int bounce = 0; bounce < 4 && timeLeft > 0; ++bounce) {
+            const float dx = velX * timeLeft, dy = velY * timeLeft;
+            const SDL_FRect box = { x, y, (float)width, (float)height };
+
+            // The closest hit so far (hitEntity stays -1 for the walls)
+            float hitTime = 2.0f;
+            int hitNormalX = 0, hitNormalY = 0;
+            SDL_Rect hitArea;
+            int hitEntity = -1;
+            auto checkHit = [&](const SDL_Rect &area, int other)
+            {
+                float time;
+                int normalX, normalY;
+                if (swept_aabb(box, dx, dy, area, time, normalX, normalY) && time < hitTime) {
+                    hitTime = time;
+                    hitNormalX = normalX;
+                    hitNormalY = normalY;
+                    hitArea = area;
+                    hitEntity = other;
                 }
+            };
+
+            // The top and bottom of the screen are walls. They're treated as rectangles just outside the screen, stretching far to the sides.
+            checkHit({ -m_width, -m_height, m_width * 3, m_height }, -1);
+            checkHit({ -m_width, m_height, m_width * 3, m_height }, -1);
+
+            // Then, every entity near the path of the ball
+            SDL_Rect path = {
+                (int)floorf(std::min(x, x + dx)), (int)floorf(std::min(y, y + dy)),
+                (int)ceilf(fabsf(dx)) + width + 1, (int)ceilf(fabsf(dy)) + height + 1
+            };
+            m_grid.query(path, m_bodies.collidesWith[e], [&](entity other)
+            {
+                // The ball can't hit itself
+                if (other != e)
+                    checkHit(m_bodies.bounding_box(other), other);
+                return false;
+            });
+
+            // If nothing is in the way, just move
+            if (hitTime > 1.0f) {
+                x += dx;
+                y += dy;
+                break;
+            }
 
-            } else if (auto iter = std::find(m_collided.begin(), m_collided.end(), obj.get()); iter != m_collided.end()) {
-                // This only runs if we're not colliding with an object but it's present in the colliding list; in that case, we remove it from the list
-                m_collided.erase(iter);
+            // Otherwise, move up to the point of impact. We then line the ball up exactly with the face that was hit, so that rounding errors can't leave
+            // it stuck inside (this also pushes the ball out if something moved into it)
+            x += dx * hitTime;
+            y += dy * hitTime;
+            if (hitNormalX < 0)
+                x = hitArea.x - width;
+            else if (hitNormalX > 0)
+                x = hitArea.x + hitArea.w;
+            if (hitNormalY < 0)
+                y = hitArea.y - height;
+            else if (hitNormalY > 0)
+                y = hitArea.y + hitArea.h;
+
+            // Bounce off the face that was hit (unless we're already moving away from it)
+            if (velX * hitNormalX < 0)
+                velX = -velX;
+            if (velY * hitNormalY < 0)
+                velY = -velY;
+
+            // And if it's a paddle that we're colliding with...
+            if (hitEntity >= 0 && (m_bodies.layers[hitEntity] & LAYER_PADDLE)) {
+                // ...then bounce from paddle. (not physically accurate in the slightest)
+                float dirX = velX / ball.speed, dirY = velY / ball.speed;
+                dirY += m_bodies.velY[hitEntity] * 0.003f;
+                float length = sqrtf(dirX * dirX + dirY * dirY);
+                velX = dirX / length * ball.speed;
+                velY = dirY / length * ball.speed;
+                // Let the rest of the game know
+                m_events.push({ pong_event::paddle_hit, -1, ball.id, (entity)hitEntity });
             }
-        }
 
-        // Bounce off the top and bottom
-        if (m_y > m_maxY - m_texHeight) {
-            m_y = m_maxY - m_texHeight;
-            m_dirY = -m_dirY;
-        }
-        if (m_y < 0) {
-            m_y = 0;
-            m_dirY = -m_dirY;
+            timeLeft -= timeLeft * hitTime;
         }
 
-        // Give points if the ball went off the side
-        if (m_x < 0) {
-            SDL_Event user_event;
-            user_event.type = givePointEventType;
-            user_event.user.data1 = (void*)1;
-            // HACK! We should have a way to send events between objects, not this!
-            sdlCall(SDL_PushEvent)(&user_event);
-        }
-        if (m_x > m_maxX - m_texWidth) {
-            SDL_Event user_event;
-            user_event.type = givePointEventType;
-            user_event.user.data1 = (void*)0;
-            // HACK! We should have a way to send events between objects, not this!
-            sdlCall(SDL_PushEvent)(&user_event);
-        }
+        // Give points if the ball went off the side (they're applied once everything is updated)
+        if (x < 0)
+            m_events.push({ pong_event::goal_scored, 1, ball.id });
+        if (x > m_width - width)
+            m_events.push({ pong_event::goal_scored, 0, ball.id });
     }
-};
-
-// Implementations of scoreboard methods
+}
 
-void scoreboard::update_score_text()
+void pong_world::reset()
 {
-    // We just delegate to the update_text(...) helper function, formatting the score nicely
-    update_text(m_renderer, m_font, std::to_string(m_score1) + " - " + std::to_string(m_score2), { 0, 0, 0, 255 }, m_texture, m_texWidth, m_texHeight);
+    // Reset every entity's position to its original state. The previous position is reset too -- the entity is teleported, we don't want to draw it
+    // sliding across the screen
+    m_bodies.x = m_bodies.prevX = m_bodies.startX;
+    m_bodies.y = m_bodies.prevY = m_bodies.startY;
+    std::fill(m_bodies.velX.begin(), m_bodies.velX.end(), 0.0f);
+    std::fill(m_bodies.velY.begin(), m_bodies.velY.end(), 0.0f);
+
+    // The balls start off moving to the right
+    for (const ball_component &ball : m_balls)
+        m_bodies.velX[ball.id] = ball.speed;
+
+    // Everything was teleported, so the grid has to be filed again (nothing has moved since)
+    m_grid.rebuild(m_bodies, 0);
 }
 
-// The constructor for a scoreboard object
-scoreboard::scoreboard(SDL_Renderer *renderer, TTF_Font *font, int startX, int startY)
-    : object{renderer, NULL, startX, startY}, m_font{font}  // Set the font used
+void pong_world::draw(render_queue &queue, float alpha) const
 {
-    // Make sure to render the SDL_Texture for "0 - 0", as we will use it for drawing later
-    update_score_text();
+    // The render queue batches the goals into one SDL_RenderFillRects call, and the sprites into one SDL_RenderGeometry call, so drawing takes the same
+    // amount of calls however many paddles and balls there are.
+    // Goals don't have a sprite, they're just black rectangles (and they don't move, so there's nothing to interpolate)
+    for (entity e = 0; e < m_bodies.size(); ++e) {
+        if (m_bodies.kind[e] == entity_kind::goal)
+            queue.fill_rect(DRAW_WALLS, m_bodies.bounding_box(e), { 0, 0, 0, 255 });
+    }
+
+    // Everything else is drawn with its sprite, in between its previous and current position
+    for (entity e = 0; e < m_bodies.size(); ++e) {
+        const SDL_Rect &sprite = m_bodies.sprite[e];
+        if (sprite.w == 0)
+            continue;
+        // Whole pixels, like SDL_RenderCopy with an SDL_Rect used to do, so that the sprites stay sharp
+        float x = (int)(m_bodies.prevX[e] + (m_bodies.x[e] - m_bodies.prevX[e]) * alpha);
+        float y = (int)(m_bodies.prevY[e] + (m_bodies.y[e] - m_bodies.prevY[e]) * alpha);
+        queue.copy(DRAW_SPRITES, m_sprites->texture(), m_sprites->width(), m_sprites->height(), sprite, { x, y, (float)m_bodies.width[e], (float)m_bodies.height[e] });
+    }
+
+    m_scores.draw(queue, DRAW_TEXT);
 }
 
-// The move constructor for a scoreboard object. Permits the moving of this object
-scoreboard::scoreboard(scoreboard &&other)
-    : object{other} /* Use the move constructor for object */, m_font{other.m_font} /* and just copy the font ID */
+const body_components &pong_world::bodies() const
 {
-    // The new object (us) will copy the score from the old object (them)
-    m_score1 = other.m_score1;
-    m_score2 = other.m_score2;
-    // We took ownership of the SDL_Texture, make sure the old object cannot use or deallocate it on accident anymore
-    other.m_texture = NULL;
+    return m_bodies;
 }
 
-// A function to draw the scoreboard (it's a bit different, as the scoreboard is the only object anchored to its center. Also kind of a hack)
-void scoreboard::draw() const
+const scoreboard &pong_world::scores() const
 {
-    // Draw the text anchored to the middle
-    SDL_Rect srcrect = { 0, 0, m_texWidth, m_texHeight };
-    SDL_Rect dstrect = { (int)(m_x - m_texWidth / 2.0f), (int)m_y, m_texWidth, m_texHeight };
-    sdlCall(SDL_RenderCopy)(m_renderer, m_texture, &srcrect, &dstrect);
+    return m_scores;
 }
 
-scoreboard::~scoreboard()
+const rally_stats &pong_world::rallies() const
 {
-    // We own the texture, so make sure to destroy it (if we actually own it tho don't destroy it if it's NULL)
-    if (m_texture)
-        SDL_DestroyTexture(m_texture);
+    return m_rallies;
 }
 
-// Add a point to a player
-void scoreboard::addPoint(int player)
+uint64_t pong_world::dropped_events() const
 {
-    // No need for an array when there's just 2 players. I think. Not sure if this is best practice
-    if (player == 0)
-        ++m_score1;
-    else
-        ++m_score2;
-
-    // Make sure to change the displayed text afterwards!
-    update_score_text();
+    return m_events.dropped();
 }
 
-// Hacky way to exclude the scoreboard from acting as an object the ball can deflect from
-bool scoreboard::can_collide() const
+const std::vector<SDL_Scancode> &pong_world::control_keys() const
 {
-    return false;
+    return m_controlKeys;
 }
 
 
@@ -265,92 +367,64 @@ bool scoreboard::can_collide() const
 pong_scene::pong_scene(scenes &scenes, SDL_Renderer *renderer, bool hockeyMode)
     : scene{scenes, renderer}
 {
-    // Load the font and the textures used
-    m_font = sdlCall(TTF_OpenFont)("Terminus.ttf", 32);
-    m_tex1 = sdlCall(IMG_LoadTexture)(m_renderer, "paddle.png");
-    m_tex2 = sdlCall(IMG_LoadTexture)(m_renderer, "ball.png");
-
-    // Add player paddles to the game
-    m_objects.emplace_back(new paddle{m_renderer, m_tex1, 25, SCREEN_HEIGHT / 2 - 64, 300.0f, SDLK_q, SDLK_a});
-    m_objects.emplace_back(new paddle{m_renderer, m_tex1, SCREEN_WIDTH - 25 - 32, SCREEN_HEIGHT / 2 - 64, 300.0f, SDLK_o, SDLK_l});
-
-    if (hockeyMode) {
-        // Add more player paddles to the game
-        m_objects.emplace_back(new paddle{m_renderer, m_tex1, 250, SCREEN_HEIGHT / 2 - 64, 300.0f, SDLK_w, SDLK_s});
-        m_objects.emplace_back(new paddle{m_renderer, m_tex1, SCREEN_WIDTH - 250 - 32, SCREEN_HEIGHT / 2 - 64, 300.0f, SDLK_i, SDLK_k});
-        m_objects.emplace_back(new paddle{m_renderer, m_tex1, 350, SCREEN_HEIGHT / 2 - 64, 300.0f, SDLK_e, SDLK_d});
-        m_objects.emplace_back(new paddle{m_renderer, m_tex1, SCREEN_WIDTH - 350 - 32, SCREEN_HEIGHT / 2 - 64, 300.0f, SDLK_u, SDLK_j});
-        // Add goals to the game
-        m_objects.emplace_back(new goal{m_renderer, 0, 64, 320});
-        m_objects.emplace_back(new goal{m_renderer, SCREEN_WIDTH - 64, 64, 320});
-    }
-
-    // Add ball to the game
-    m_objects.emplace_back(new ball{m_renderer, m_tex2, SCREEN_WIDTH / 2 - 16, SCREEN_HEIGHT / 2 - 16, 300.0f});
-
-    // Add scoreboard to the game
-    m_scores = dynamic_cast<scoreboard*>(m_objects.emplace_back(new scoreboard{m_renderer, m_font, SCREEN_WIDTH / 2, 0}).get());
+    // Load the font and the sprites in the background (if they're in the cache already, this is done on the next frame), and only then build the world
+    asset_manifest manifest = {
+        .fonts = { { "Terminus.ttf", 32 } },
+        .spriteAtlases = { { "paddle.png", "ball.png" } },
+    };
+    m_loadRequest = scenes.assets().load_async(manifest, [this](std::size_t loaded, std::size_t total)
+    {
+        m_loadProgress = (float)loaded / total;
+    }, [this, &scenes, renderer, hockeyMode]()
+    {
+        m_atlas = scenes.assets().atlas("Terminus.ttf", 32);
+        m_sprites = scenes.assets().sprites({ "paddle.png", "ball.png" });
+        m_world = std::make_unique<pong_world>(renderer, m_sprites.get(), m_atlas.get(), hockeyMode);
+    });
 }
 
 pong_scene::~pong_scene()
 {
-    // Free all the resources
-    sdlCall(SDL_DestroyTexture)(m_tex1);
-    sdlCall(SDL_DestroyTexture)(m_tex2);
-
-    sdlCall(TTF_CloseFont)(m_font);
+    m_scenes.assets().cancel(m_loadRequest);
 }
 
 void pong_scene::update(float deltaTime)
 {
-    // For every object that exists
-    for (auto &object : m_objects)
-        // Update it
-        object->update(deltaTime, m_objects);
+    // Nothing happens while loading
+    if (!m_world)
+        return;
+
+    // The keyboard is looked at once per update, and the world works off of that snapshot
+    m_world->update(deltaTime, input_state::from_keyboard());
 }
 
-void pong_scene::draw() const
+void pong_scene::draw(render_queue &queue, float alpha) const
 {
     // Clear the screen
     // FIXME: This function should be able to tell its owner that it needn't draw any scenes below
-    sdlCall(SDL_SetRenderDrawColor)(m_renderer, 255, 255, 255, 255);
-    sdlCall(SDL_RenderClear)(m_renderer);
+    queue.clear({ 255, 255, 255, 255 });
 
-    // For every object that exists
-    for (auto &object : m_objects)
-        // Draw it
-        object->draw();
+    if (m_world) {
+        m_world->draw(queue, alpha);
+        return;
+    }
+
+    // Still loading, so show how far along that is, with a bar in the middle of the screen (it can't be text, the font might not be loaded yet). The
+    // queue only draws filled rectangles, so the outline is a black rectangle with a white one inside it
+    const auto [windowW, windowH] = m_scenes.window_dimensions();
+    SDL_Rect outline = { windowW / 4, windowH / 2 - 16, windowW / 2, 32 };
+    SDL_Rect inside = { outline.x + 2, outline.y + 2, outline.w - 4, outline.h - 4 };
+    SDL_Rect filled = { outline.x + 4, outline.y + 4, (int)((outline.w - 8) * m_loadProgress), outline.h - 8 };
+    queue.fill_rect(0, outline, { 0, 0, 0, 255 });
+    queue.fill_rect(1, inside, { 255, 255, 255, 255 });
+    queue.fill_rect(2, filled, { 0, 0, 0, 255 });
 }
 
 void pong_scene::on_event(const SDL_Event &event)
 {
-    // If a key is pressed
-    if (event.type == SDL_KEYDOWN) {
-        // And that key is escape
-        if (event.key.keysym.sym == SDLK_ESCAPE) {
-            // Then exit from the pong game, back into the main menu (or whatever other scene was underneath)
-            m_scenes.pop_scene();
-        } else {
-            // We don't know what to do with this key, but the objects might, so for every object that exists
-            for (auto &object : m_objects) {
-                // Call its keyDown function
-                object->keyDown(event.key.keysym.sym);
-            }
-        }
-
-    // If a key is released
-    } else if (event.type == SDL_KEYUP) {
-        // Notify every object of the event
-        for (auto &object : m_objects)
-            object->keyUp(event.key.keysym.sym);
-
-    // If a point is gained (HACK)
-    } else if (event.type == givePointEventType) {
-        // Reset the world
-        for (auto &object : m_objects)
-            object->reset();
-
-        // Update the score
-        m_scores->addPoint((intptr_t)event.user.data1);
+    // If a key is pressed, and that key is escape (the paddle controls are read in update())
+    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
+        // Then exit from the pong game, back into the main menu (or whatever other scene was underneath)
+        m_scenes.pop_scene();
     }
 }
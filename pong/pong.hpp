@@ -1,46 +1,146 @@
 #ifndef GAMES_PONG_PONG_HPP
 #define GAMES_PONG_PONG_HPP
 
+#include <tuple>          // std::tuple
+#include <vector>         // std::vector
+#include <memory>         // std::shared_ptr
+#include <cstdint>        // uint64_t
+
 #include "../scene.hpp"
-#include "object.hpp"
+#include "../utils.hpp"
+#include "../input.hpp"
+#include "../event_queue.hpp"
+#include "../font_atlas.hpp"
+#include "../sprite_atlas.hpp"
+#include "../render_queue.hpp"
+#include "components.hpp"
+#include "collision_grid.hpp"
 
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
-// An object that handles the scoreboard
-class scoreboard : public object
+// The sizes of the paddle.png and ball.png sprites. They're needed to lay out the game even when the textures aren't loaded (as is the case without a window)
+const int PADDLE_WIDTH = 32, PADDLE_HEIGHT = 128;
+const int BALL_SIZE = 32;
+
+// The scoreboard, drawn at the top middle of the screen. It isn't an entity, the game logic never touches it besides adding points.
+class scoreboard
 {
-    TTF_Font *const m_font;  // The font used to render it
+    const font_atlas *const m_font;  // The font used to draw it (NULL when there's no window)
+    const int m_x, m_y;  // The position of the middle of the top edge of the text
     int m_score1 = 0, m_score2 = 0;  // Scores of both the players
-    void update_score_text();  // Internal helper function to update the displayed text's texture
 public:
-    scoreboard(SDL_Renderer *renderer, TTF_Font *font, int startX, int startY);   // Constructor for the scoreboard object
+    scoreboard(const font_atlas *font, int x, int y);   // Constructor for the scoreboard
     scoreboard(const scoreboard &) = delete;  // Don't allow copying it
-    scoreboard(scoreboard &&other);  // Moving it is allowed, though
-    virtual void draw() const override;  // We override the draw() function, as the object has custom behavior for that
-    ~scoreboard();  // The destructor is overriden as well to let go of the allocated texture
+    void draw(render_queue &queue, int layer) const;  // Draws the score (the text is put together on the spot, it's cheap to draw from the font atlas)
     void addPoint(int player);  // A public function to add a point to a player
-    virtual bool can_collide() const override;  // We also override the can_collide() function
+    std::tuple<int, int> scores() const;  // A public function to get the scores of both players
+};
+
+// Statistics about the rallies (the paddle hits in between points) of a game
+struct rally_stats
+{
+    uint64_t paddleHits = 0;  // How many times the ball bounced off a paddle in total
+    unsigned rallies = 0;  // How many rallies were finished (so, how many points were given)
+    unsigned longestRally = 0;  // The most paddle hits in a single rally
+
+    double average_rally() const;  // The average amount of paddle hits per rally
+};
+
+// The messages sent in between the systems of a pong world. They're queued while the systems run, and handled at the end of the update (see
+// pong_world::handle_events), so a system never has to deal with the world changing under it.
+struct pong_event
+{
+    enum type_t
+    {
+        goal_scored,  // The ball went off the side, `player` gets a point
+        paddle_hit,   // `ball` bounced off the paddle `paddle`
+        reset,        // Every entity goes back to its starting position
+    } type;
+    int player = -1;
+    entity ball = 0, paddle = 0;
+};
+
+// The state of a single game of pong (or hockey) -- its entities, and the systems that make up the rules of the game. It is separate from pong_scene so
+// that it can also be simulated without a window (see pong/headless.hpp). In that case, the renderer, the sprite atlas, and the font atlas are all NULL.
+// A world doesn't share any state with other worlds, so many of them can be updated at once on different threads (see pong/batch.hpp).
+class pong_world final
+{
+    SDL_Renderer *const m_renderer;  // The renderer used for drawing (NULL when there's no window)
+    const sprite_atlas *const m_sprites;  // The paddle and ball sprites (NULL when there's no window)
+    int m_width, m_height;  // The size of the playing field (the screen)
+
+    // The entities, and their components (see pong/components.hpp)
+    body_components m_bodies;
+    std::vector<paddle_component> m_paddles;
+    std::vector<ball_component> m_balls;
+
+    scoreboard m_scores;  // Keeps (and shows) the score
+    std::vector<SDL_Scancode> m_controlKeys;  // Every key that controls a paddle in this game
+    // The events sent during the current update. A ball sends at most 6 per update (a paddle hit per bounce, and a goal), so with the one ball of a game
+    // there's lots of room to spare -- and if it ever does fill up, the extra events are dropped and counted (see dropped_events)
+    event_queue<pong_event, 64> m_events;
+    unsigned m_currentRally = 0;  // How many paddle hits happened since the last point
+    rally_stats m_rallies;  // Statistics about all the rallies so far
+    collision_grid m_grid;  // Finds the entities close to each other, rebuilt once the paddles have moved in every update (and after a reset)
+
+    // The layers of the render queue that the world is drawn on, from the bottom up
+    enum draw_layer
+    {
+        DRAW_WALLS,
+        DRAW_SPRITES,
+        DRAW_TEXT,
+    };
+
+    // The systems. Each goes through the components it needs, in order.
+    void update_paddles(float deltaTime, const input_state &input);  // Moves the paddles according to the keys held
+    void update_balls(float deltaTime);  // Moves the balls, bouncing them off everything, and gives points when they go off the side
+    void reset();  // Puts every entity back at its starting position
+    void handle_events();  // Handles (and empties) the queued events
+
+public:
+    pong_world(SDL_Renderer *renderer, const sprite_atlas *sprites, const font_atlas *font, bool hockeyMode);  // Builds all the entities of the game
+    pong_world(const pong_world &) = delete;  // We don't allow copying it
+
+    // Calls visit(entity) for every entity on any of the given collision layers that overlaps the given area. visit can return true to stop early, in
+    // which case this returns true as well.
+    template<typename F>
+    bool for_each_touching(const SDL_Rect &area, uint32_t layers, F &&visit)
+    {
+        return m_grid.query(area, layers, [&](entity other)
+        {
+            return aabb_overlap(area, m_bodies.bounding_box(other)) && visit(other);
+        });
+    }
+
+    void update(float deltaTime, const input_state &input);  // Advances the game by deltaTime seconds, with the given keys held down
+    void draw(render_queue &queue, float alpha) const;  // Draws every entity, alpha of the way between their previous and current positions (only when there's a window)
+
+    const body_components &bodies() const;  // Gives access to the entities
+    const scoreboard &scores() const;  // Gives access to the scoreboard
+    const rally_stats &rallies() const;  // Gives the rally statistics
+    uint64_t dropped_events() const;  // How many events didn't fit into the event queue (should be 0)
+    const std::vector<SDL_Scancode> &control_keys() const;  // Gives the list of keys that control the paddles
 };
 
 // The scene of the pong game
 class pong_scene final : public scene
 {
-    TTF_Font *m_font;  // Holds the font used in the game
-    SDL_Texture *m_tex1, *m_tex2;  // Holds 2 textures
-    std::vector<std::unique_ptr<object>> m_objects;  // Holds a list of objects
-    scoreboard *m_scores;  // A cached pointer to the scoreboard object specifically
+    // The font and the sprites used in the game. They come from the asset cache, so entering the game again doesn't load them again
+    std::shared_ptr<const font_atlas> m_atlas;
+    std::shared_ptr<const sprite_atlas> m_sprites;
+    std::unique_ptr<pong_world> m_world;  // Holds the game itself. It's only made once the assets are loaded, until then a loading bar is shown instead
+
+    unsigned m_loadRequest;  // The background loading request of the assets (see asset_cache::load_async)
+    float m_loadProgress = 0.0f;  // How much of the assets is loaded (0 to 1)
 
 public:
     pong_scene(scenes &scenes, SDL_Renderer *renderer, bool hockeyMode);  // Constructor for pong_scene; invoked by scenes::push_scene<pong_scene>(bool), it takes hockeyMode as a required parameter
-    ~pong_scene();   // Destructor for the pong scene, releases resources
+    ~pong_scene();  // Stops waiting for the assets, if they're still loading
     void update(float deltaTime) override;  // We override the update function
-    void draw() const override;  // As well as the drawing function
+    void draw(render_queue &queue, float alpha) const override;  // As well as the drawing function
     void on_event(const SDL_Event &event) override; // As well as the function that responds to SDL events
 };
 
-// Bit of a hack -- we have a global variable holding a custom event ID. I use the SDL event loop for communiaction here, as I have no other mechanism for hat
-extern uint32_t givePointEventType;
-
 #endif  // GAMES_PONG_PONG_HPP
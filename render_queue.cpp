@@ -0,0 +1,166 @@
+#include "render_queue.hpp"
+#include "utils.hpp"
+
+#include <algorithm>  // std::find
+#include <stdexcept>  // std::length_error
+
+static uint32_t pack_color(SDL_Color color)
+{
+    return (uint32_t)color.r << 24 | (uint32_t)color.g << 16 | (uint32_t)color.b << 8 | color.a;
+}
+
+void render_queue::push(const command &cmd)
+{
+    // There's only a handful of textures in a frame, so a linear search is the quickest way to number them. NULL is always number 0
+    uint64_t textureIndex = 0;
+    if (cmd.texture) {
+        auto iter = std::find(m_textures.begin(), m_textures.end(), cmd.texture);
+        textureIndex = iter - m_textures.begin() + 1;
+        if (iter == m_textures.end()) {
+            if (m_textures.size() == 255)
+                throw std::length_error("render_queue can only hold 255 textures per frame");
+            m_textures.push_back(cmd.texture);
+        }
+    }
+
+    // The layer is shifted, so that negative layers sort below positive ones
+    uint64_t layer = (uint16_t)(cmd.layer + 32768);
+    m_keys.push_back({ (uint64_t)m_pass << 56 | layer << 40 | textureIndex << 32 | cmd.color, (uint32_t)m_commands.size() });
+    m_commands.push_back(cmd);
+}
+
+void render_queue::next_pass()
+{
+    if (m_pass == 255)
+        throw std::length_error("render_queue can only hold 255 passes per frame");
+    ++m_pass;
+}
+
+void render_queue::clear(SDL_Color color)
+{
+    push({ .layer = -32768, .color = pack_color(color), .clear = true });
+}
+
+void render_queue::fill_rect(int layer, const SDL_Rect &rect, SDL_Color color)
+{
+    push({ .layer = layer, .color = pack_color(color), .dst = { (float)rect.x, (float)rect.y, (float)rect.w, (float)rect.h } });
+}
+
+void render_queue::copy(int layer, SDL_Texture *texture, int texWidth, int texHeight, const SDL_Rect &src, const SDL_FRect &dst, SDL_Color color)
+{
+    push({ .layer = layer, .texture = texture, .color = pack_color(color), .dst = dst, .src = src, .texWidth = texWidth, .texHeight = texHeight });
+}
+
+void render_queue::sort_keys()
+{
+    // A radix sort: the keys are sorted by their lowest byte, then by the next one, and so on. Every step is stable, so in the end they're sorted by the
+    // whole key, and equal keys stay in the order they were recorded in. Bytes that are the same in every key (most of them, usually) are skipped.
+    // Unlike std::sort, this doesn't compare keys against each other, so it doesn't suffer from mispredicted branches -- and the scratch array is
+    // reused, so it doesn't allocate either.
+    // The counts of every byte value, for all 8 bytes, are gathered in a single pass over the keys
+    std::size_t counts[8][256] = {};
+    for (const sort_key &k : m_keys)
+        for (int byte = 0; byte < 8; ++byte)
+            ++counts[byte][(k.key >> (byte * 8)) & 0xFF];
+
+    m_sortScratch.resize(m_keys.size());
+    for (int byte = 0; byte < 8; ++byte) {
+        const int shift = byte * 8;
+        if (m_keys.empty() || counts[byte][(m_keys[0].key >> shift) & 0xFF] == m_keys.size())
+            continue;
+
+        // Turn the counts into the positions where every byte value starts
+        std::size_t position = 0;
+        for (std::size_t &count : counts[byte]) {
+            std::size_t n = count;
+            count = position;
+            position += n;
+        }
+        for (const sort_key &k : m_keys)
+            m_sortScratch[counts[byte][(k.key >> shift) & 0xFF]++] = k;
+        m_keys.swap(m_sortScratch);
+    }
+}
+
+void render_queue::flush(SDL_Renderer *renderer)
+{
+    // Sort everything into runs that can be drawn with a single call. Clears come first in their pass, because their layer is the lowest there is
+    sort_keys();
+
+    draw_stats stats;
+    stats.commands = m_commands.size();
+    bool haveColor = false;
+    uint32_t currentColor = 0;
+    auto setColor = [&](uint32_t color)
+    {
+        // The draw color is only changed when it actually has to be
+        if (haveColor && color == currentColor)
+            return;
+        sdlCall(SDL_SetRenderDrawColor)(renderer, color >> 24, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+        haveColor = true;
+        currentColor = color;
+        ++stats.colorChanges;
+    };
+
+    // Commands in the same run have the same top 32 bits of their key (so, the same pass, layer and texture), and rectangles also need the same color
+    auto commandAt = [&](std::size_t i) -> const command & { return m_commands[m_keys[i].index]; };
+    auto sameRun = [&](std::size_t i, std::size_t j) { return (m_keys[i].key >> 32) == (m_keys[j].key >> 32); };
+    for (std::size_t i = 0; i < m_keys.size();) {
+        const command &first = commandAt(i);
+        std::size_t end = i + 1;
+
+        if (first.clear) {
+            setColor(first.color);
+            sdlCall(SDL_RenderClear)(renderer);
+
+        } else if (!first.texture) {
+            // A run of rectangles of the same color, on the same layer
+            m_rects.clear();
+            for (end = i; end < m_keys.size() && m_keys[end].key == m_keys[i].key; ++end) {
+                const SDL_FRect &dst = commandAt(end).dst;
+                m_rects.push_back({ (int)dst.x, (int)dst.y, (int)dst.w, (int)dst.h });
+            }
+            setColor(first.color);
+            sdlCall(SDL_RenderFillRects)(renderer, m_rects.data(), (int)m_rects.size());
+
+        } else {
+            // A run of quads from the same texture, on the same layer
+            m_quads.clear();
+            for (end = i; end < m_keys.size() && sameRun(end, i); ++end) {
+                const command &cmd = commandAt(end);
+                SDL_Color color = { (Uint8)(cmd.color >> 24), (Uint8)(cmd.color >> 16), (Uint8)(cmd.color >> 8), (Uint8)cmd.color };
+                m_quads.add(cmd.dst, cmd.src, cmd.texWidth, cmd.texHeight, color);
+            }
+            m_quads.draw(renderer, first.texture);
+        }
+
+        ++stats.drawCalls;
+        i = end;
+    }
+
+    m_commands.clear();
+    m_keys.clear();
+    m_textures.clear();
+    m_pass = 0;
+
+    m_lastFrame = stats;
+    m_total.commands += stats.commands;
+    m_total.drawCalls += stats.drawCalls;
+    m_total.colorChanges += stats.colorChanges;
+    ++m_frames;
+}
+
+const draw_stats &render_queue::last_frame() const
+{
+    return m_lastFrame;
+}
+
+const draw_stats &render_queue::total() const
+{
+    return m_total;
+}
+
+uint64_t render_queue::frames() const
+{
+    return m_frames;
+}
@@ -0,0 +1,79 @@
+#ifndef GAMES_RENDER_QUEUE_HPP
+#define GAMES_RENDER_QUEUE_HPP
+
+#include <vector>   // std::vector
+#include <cstdint>  // uint64_t
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+
+#include "sprite_atlas.hpp"
+
+// How much drawing a frame (or several) took
+struct draw_stats
+{
+    uint64_t commands = 0;  // How many things were asked to be drawn
+    uint64_t drawCalls = 0;  // How many SDL calls it took to draw them (clears, SDL_RenderFillRects and SDL_RenderGeometry)
+    uint64_t colorChanges = 0;  // How many times the draw color had to be changed
+};
+
+// Instead of calling the renderer directly, the scenes record what they want drawn into this queue, and it's all drawn at once at the end of the frame
+// (see scenes::mainloop). Before drawing, the commands are sorted by the scene that recorded them, their layer, their texture and their color, so that:
+//  - runs of rectangles of the same color become a single SDL_RenderFillRects call, with no draw color changes in between,
+//  - runs of quads from the same texture become a single SDL_RenderGeometry call (the color is per vertex, so it doesn't split a run).
+// The order is only kept between layers (and scenes). Within a layer, things are drawn in whatever order is cheapest, so anything that has to be drawn on
+// top of something else has to be on a higher layer. Things on the same layer are drawn in the order they were recorded only if they share a texture
+// and color. The arrays are reused from frame to frame, so once they've grown big enough, nothing is allocated.
+class render_queue final
+{
+    struct command
+    {
+        int layer = 0;
+        SDL_Texture *texture = NULL;  // NULL for rectangles of a single color
+        uint32_t color = 0;  // The color, packed into one number so that it's quick to compare
+        bool clear = false;  // Whether it clears the screen (those go below everything else in their pass)
+
+        SDL_FRect dst = {};
+        SDL_Rect src = {};  // Only used for textured quads, together with the size of the texture
+        int texWidth = 1, texHeight = 1;
+    };
+
+    // What the commands are sorted by, packed into one number: from the most important to the least, 8 bits of pass, 16 bits of layer, 8 bits of
+    // texture and 32 bits of color. Sorting these instead of the commands themselves moves a lot less memory around.
+    struct sort_key
+    {
+        uint64_t key;
+        uint32_t index;  // Which command it is (the commands are numbered in the order they were recorded)
+    };
+
+    std::vector<command> m_commands;
+    std::vector<sort_key> m_keys, m_sortScratch;
+    std::vector<SDL_Texture*> m_textures;  // The textures used in this frame. A texture's index in here stands in for it in the sort key
+
+    void sort_keys();
+    std::vector<SDL_Rect> m_rects;  // Scratch space for SDL_RenderFillRects
+    quad_batch m_quads;  // Scratch space for SDL_RenderGeometry
+    unsigned m_pass = 0;
+    draw_stats m_lastFrame, m_total;
+    uint64_t m_frames = 0;
+
+    void push(const command &cmd);
+
+public:
+    // Starts recording the commands of the next scene, which all go on top of the ones recorded until now. There can be up to 255 passes in a frame, and up
+    // to 255 textures; going over either throws std::length_error
+    void next_pass();
+
+    // The commands. The layer has to be in between -32767 and 32767
+    void clear(SDL_Color color);  // Fills the whole screen with a color, below everything else of the current pass
+    void fill_rect(int layer, const SDL_Rect &rect, SDL_Color color);  // Fills a rectangle with a color
+    void copy(int layer, SDL_Texture *texture, int texWidth, int texHeight, const SDL_Rect &src, const SDL_FRect &dst, SDL_Color color = { 255, 255, 255, 255 });  // Draws part of a texture (of the given size), tinted by color
+
+    void flush(SDL_Renderer *renderer);  // Sorts and draws every recorded command, and empties the queue
+
+    const draw_stats &last_frame() const;  // The stats of the last flush
+    const draw_stats &total() const;  // The stats of every flush so far
+    uint64_t frames() const;  // How many times the queue was flushed
+};
+
+#endif  // GAMES_RENDER_QUEUE_HPP
@@ -29,13 +29,15 @@ bool scene::active() const
 
 // The methods of the scenes object
 // The constructor
-scenes::scenes(int windowWidth, int windowHeight, std::string windowTitle)
-    : m_windowWidth{windowWidth}, m_windowHeight{windowHeight}, m_titleText{windowTitle}
+scenes::scenes(int windowWidth, int windowHeight, std::string windowTitle, int tickRate, int frameRate)
+    : m_windowWidth{windowWidth}, m_windowHeight{windowHeight}, m_tickRate{tickRate}, m_frameRate{frameRate}, m_titleText{windowTitle}
 {
     // Creating the SDL window and renderer -- the very things we wrap around
     sdlCall(SDL_CreateWindowAndRenderer)(m_windowWidth, m_windowHeight, 0, &m_window, &m_renderer);
     // Setting the title of the window to the user-provided one
     sdlCall(SDL_SetWindowTitle)(m_window, m_titleText.c_str());
+    // The assets can only be loaded once there's a renderer to upload them with
+    m_assets = std::make_unique<asset_cache>(m_renderer);
 }
 
 std::tuple<int, int> scenes::window_dimensions() const
@@ -44,6 +46,26 @@ std::tuple<int, int> scenes::window_dimensions() const
     return { m_windowWidth, m_windowHeight };
 }
 
+asset_cache &scenes::assets()
+{
+    return *m_assets;
+}
+
+const render_queue &scenes::render_stats() const
+{
+    return m_renderQueue;
+}
+
+void scenes::set_tick_rate(int tickRate)
+{
+    m_tickRate = tickRate;
+}
+
+void scenes::set_frame_rate(int frameRate)
+{
+    m_frameRate = frameRate;
+}
+
 scene &scenes::current_scene()
 {
     auto last = m_scenes.end();
@@ -68,10 +90,14 @@ scene &scenes::previous_scene()
 
 void scenes::mainloop()
 {
-    // A basic SDL mainloop
-
-    float deltaTime = 0.016;
-    uint64_t lastFrameTicks = sdlCall(SDL_GetTicks64)();  // This will be used to keep track of the time took to render a frame
+    // A fixed timestep SDL mainloop. The real time that passes is collected in an accumulator, and the active scene is updated with a constant deltaTime
+    // as many times as fits in it. That way, the simulation doesn't depend on how long the frames take. Whatever time is left over in the accumulator
+    // tells the scenes how far they are between two updates, so that they can draw their objects in between their previous and current positions.
+
+    // The high resolution timer is used, SDL_GetTicks64 only counts whole milliseconds
+    const uint64_t counterFrequency = sdlCallUnchecked(SDL_GetPerformanceFrequency)();
+    uint64_t lastFrameCounter = sdlCallUnchecked(SDL_GetPerformanceCounter)();
+    double accumulator = 0.0;
     bool running = true;
     while (running) {
         // Check events
@@ -90,26 +116,45 @@ void scenes::mainloop()
             }
         }
 
-        // Only update the last scene
-        auto last = m_scenes.end();
-        if (last != m_scenes.begin()) {
-            --last;
-            (*last)->update(deltaTime);
+        // Collect the time it took since the last frame. If it was very long (say, the window was being dragged), only a quarter of a second is simulated,
+        // otherwise we'd spend so much time catching up that the next frame would take even longer.
+        uint64_t currentFrameCounter = sdlCallUnchecked(SDL_GetPerformanceCounter)();
+        double frameTime = (double)(currentFrameCounter - lastFrameCounter) / counterFrequency;
+        lastFrameCounter = currentFrameCounter;
+        accumulator += frameTime < 0.25 ? frameTime : 0.25;
+
+        // Only update the last scene, once for every time step that has passed
+        const double tickTime = 1.0 / m_tickRate;
+        while (accumulator >= tickTime) {
+            auto last = m_scenes.end();
+            if (last != m_scenes.begin()) {
+                --last;
+                (*last)->update(tickTime);
+            }
+            accumulator -= tickTime;
         }
 
-        // Draw every scene, making sure the active scene is drawn last (so, on top of all the other ones)
-        for (const auto &scene : m_scenes)
-            scene->draw();
+        // Give the assets that were loaded in the background to the scenes that are waiting for them. Only a few milliseconds are spent on that per
+        // frame, so that loading doesn't make the game stutter
+        m_assets->pump(0.004);
+
+        // Draw every scene, making sure the active scene is drawn last (so, on top of all the other ones). Each scene gets its own pass of the render
+        // queue, and the whole frame is drawn at once, right before presenting it
+        const float alpha = accumulator / tickTime;
+        for (const auto &scene : m_scenes) {
+            m_renderQueue.next_pass();
+            scene->draw(m_renderQueue, alpha);
+        }
+        m_renderQueue.flush(m_renderer);
         sdlCall(SDL_RenderPresent)(m_renderer);
 
-        // Lock the framerate
-        uint64_t currentFrameTicks = sdlCall(SDL_GetTicks64)();
-        deltaTime = (currentFrameTicks - lastFrameTicks) / 1000.0f;
-        if (deltaTime < 0.016f) {
-            sdlCall(SDL_Delay)(16 - 1000 * deltaTime);
+        // Limit the framerate, if asked to. Updates don't depend on this anymore, it only avoids drawing more frames than anyone would see
+        if (m_frameRate > 0) {
+            double elapsed = (double)(sdlCallUnchecked(SDL_GetPerformanceCounter)() - lastFrameCounter) / counterFrequency;
+            double remaining = 1.0 / m_frameRate - elapsed;
+            if (remaining > 0)
+                sdlCallUnchecked(SDL_Delay)(remaining * 1000);
         }
-        deltaTime = (sdlCall(SDL_GetTicks64)() - lastFrameTicks) / 1000.0f;
-        lastFrameTicks = currentFrameTicks;
 
         // If there are no scenes left to run, that means that the game should quit
         if (m_scenes.size() == 0)
@@ -3,12 +3,16 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 #include <tuple>
 #include <type_traits>
 
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
 
+#include "asset_cache.hpp"
+#include "render_queue.hpp"
+
 class scenes;
 
 // class that describes a scene of the game (so, basically a bundle of unique behavior, a game-state)
@@ -24,8 +28,8 @@ public:
     bool active() const;  // Returns true if this scene is on top of the scenes stack
 
     // These 3 methods are marked as abstract -- any scene has to implement them
-    virtual void draw() const = 0;  // Called on draw; is expected to not modify the scene's state
-    virtual void update(float deltaTime) = 0;  // Called on update; is allowed to modify state, gets an argument that contains the time it took to render the last frame
+    virtual void draw(render_queue &queue, float alpha) const = 0;  // Called on draw; is expected to not modify the scene's state, only to record what it looks like into the queue. alpha (0 to 1) tells how far we are between the last update and the next one, for interpolation
+    virtual void update(float deltaTime) = 0;  // Called on update; is allowed to modify state, gets an argument that contains the (fixed) time step of the simulation
     virtual void on_event(const SDL_Event &event) = 0;  // Called on an SDL event
 
     // These 2 methods are special hooks invoked when the scene is paused or unpaused. This isn't actually ever used, I probably could have done without it. I included it for completeness' sake.
@@ -38,15 +42,24 @@ class scenes final {
     SDL_Renderer *m_renderer;  // The SDL_Renderer attached to the game window
     SDL_Window *m_window;  // The game window
 
+    // The textures and fonts used by the scenes. It's made once the renderer exists, and it's declared before the scenes so that it outlives them
+    std::unique_ptr<asset_cache> m_assets;
+    render_queue m_renderQueue;  // What the scenes want drawn in the current frame
     std::vector<std::unique_ptr<scene>> m_scenes;  // The stack of scenes. Only the top one is "active" -- all are rendered, but only the top one is updated or receives events.
 
     const int m_windowWidth, m_windowHeight;  // Helper constants that contain the game window dimensions
+    int m_tickRate;  // How many times per second the active scene is updated
+    int m_frameRate;  // How many times per second the scenes are drawn at most (0 means there's no limit)
     const std::string m_titleText;  // A string containing the window caption text. Put it here because I'm not sure if SDL copies the window caption string or no (I checked and it does, but it's too late to do changes)
 public:
-    scenes(int windowWidth, int windowHeight, std::string windowTitle);  // The constructor. You give it all the data necessary to create the game window
+    scenes(int windowWidth, int windowHeight, std::string windowTitle, int tickRate = 120, int frameRate = 60);  // The constructor. You give it all the data necessary to create the game window, as well as the update and drawing rates
     scenes(const scene &) = delete;  // We don't permit copying of this object (it wouldn't make much sense)
 
     std::tuple<int, int> window_dimensions() const;  // A method that gives the dimensions of the game window
+    asset_cache &assets();  // Gives the asset cache shared by all the scenes
+    const render_queue &render_stats() const;  // Gives the render queue, to look at its draw statistics
+    void set_tick_rate(int tickRate);  // Changes how many times per second the active scene is updated
+    void set_frame_rate(int frameRate);  // Changes the drawing rate limit (0 disables it)
 
     // A method that allows you to switch to another scene. The scene is pushed on the stack -- that means that the scene that was active before will become
     // inactive, BUT will still be rendered. This is to allow stacked menus and such; something that in the end I never did
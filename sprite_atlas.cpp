@@ -0,0 +1,130 @@
+#include "sprite_atlas.hpp"
+#include "utils.hpp"
+
+#include <stdexcept>  // std::out_of_range
+#include <algorithm>  // std::max
+
+void quad_batch::clear()
+{
+    m_vertices.clear();
+    m_indices.clear();
+}
+
+void quad_batch::add(const SDL_FRect &dst, SDL_Color color)
+{
+    // Without a texture, the texture coordinates don't matter
+    add(dst, { 0, 0, 0, 0 }, 1, 1, color);
+}
+
+void quad_batch::add(const SDL_FRect &dst, const SDL_Rect &src, int texWidth, int texHeight, SDL_Color color)
+{
+    // The texture coordinates go from 0 to 1 across the whole texture
+    const float u1 = (float)src.x / texWidth, v1 = (float)src.y / texHeight;
+    const float u2 = (float)(src.x + src.w) / texWidth, v2 = (float)(src.y + src.h) / texHeight;
+
+    const int first = (int)m_vertices.size();
+    m_vertices.push_back({ { dst.x, dst.y }, color, { u1, v1 } });
+    m_vertices.push_back({ { dst.x + dst.w, dst.y }, color, { u2, v1 } });
+    m_vertices.push_back({ { dst.x + dst.w, dst.y + dst.h }, color, { u2, v2 } });
+    m_vertices.push_back({ { dst.x, dst.y + dst.h }, color, { u1, v2 } });
+    for (int index : { 0, 1, 2, 0, 2, 3 })
+        m_indices.push_back(first + index);
+}
+
+std::size_t quad_batch::size() const
+{
+    return m_vertices.size() / 4;
+}
+
+void quad_batch::draw(SDL_Renderer *renderer, SDL_Texture *texture) const
+{
+    if (!m_vertices.empty())
+        sdlCall(SDL_RenderGeometry)(renderer, texture, m_vertices.data(), (int)m_vertices.size(), m_indices.data(), (int)m_indices.size());
+}
+
+
+sprite_atlas::sprite_atlas(SDL_Renderer *renderer, const std::vector<std::string> &paths)
+    : m_names{paths}
+{
+    std::vector<SDL_Surface*> surfaces;
+    try {
+        for (const std::string &path : paths)
+            surfaces.push_back(sdlCall(IMG_Load)(path.c_str()));
+    } catch (const sdl_error &) {
+        for (SDL_Surface *surface : surfaces)
+            SDL_FreeSurface(surface);
+        throw;
+    }
+    pack(renderer, surfaces);
+}
+
+sprite_atlas::sprite_atlas(SDL_Renderer *renderer, const std::vector<std::string> &paths, const std::vector<SDL_Surface*> &surfaces)
+    : m_names{paths}
+{
+    pack(renderer, surfaces);
+}
+
+void sprite_atlas::pack(SDL_Renderer *renderer, const std::vector<SDL_Surface*> &surfaces)
+{
+    // Put the images next to each other, left to right, with a pixel of space in between so that they don't bleed into each other when scaled. There's
+    // only a handful of sprites, so a single row is good enough.
+    m_width = 1;
+    m_height = 0;
+    for (SDL_Surface *surface : surfaces) {
+        m_regions.push_back({ m_width, 1, surface->w, surface->h });
+        m_width += surface->w + 1;
+        m_height = std::max(m_height, surface->h + 2);
+    }
+
+    // Copy them into one surface (without blending, so that their transparency is copied as is), and upload that. The images are freed either way
+    SDL_Surface *atlas = NULL;
+    auto freeAll = [&]()
+    {
+        for (SDL_Surface *surface : surfaces)
+            SDL_FreeSurface(surface);
+        if (atlas)
+            SDL_FreeSurface(atlas);
+    };
+    try {
+        atlas = sdlCall(SDL_CreateRGBSurfaceWithFormat)(0, m_width, m_height, 32, SDL_PIXELFORMAT_RGBA32);
+        for (std::size_t i = 0; i < surfaces.size(); ++i) {
+            SDL_Rect dst = m_regions[i];  // SDL_BlitSurface writes the clipped rectangle back into this
+            sdlCall(SDL_SetSurfaceBlendMode)(surfaces[i], SDL_BLENDMODE_NONE);
+            sdlCall(SDL_BlitSurface)(surfaces[i], NULL, atlas, &dst);
+        }
+        m_texture = sdlCall(SDL_CreateTextureFromSurface)(renderer, atlas);
+    } catch (const sdl_error &) {
+        freeAll();
+        throw;
+    }
+    freeAll();
+    sdlCall(SDL_SetTextureBlendMode)(m_texture, SDL_BLENDMODE_BLEND);
+}
+
+sprite_atlas::~sprite_atlas()
+{
+    sdlCall(SDL_DestroyTexture)(m_texture);
+}
+
+SDL_Rect sprite_atlas::region(std::string_view name) const
+{
+    for (std::size_t i = 0; i < m_names.size(); ++i)
+        if (m_names[i] == name)
+            return m_regions[i];
+    throw std::out_of_range("there's no sprite called " + std::string(name) + " in the atlas");
+}
+
+SDL_Texture *sprite_atlas::texture() const
+{
+    return m_texture;
+}
+
+int sprite_atlas::width() const
+{
+    return m_width;
+}
+
+int sprite_atlas::height() const
+{
+    return m_height;
+}
@@ -0,0 +1,50 @@
+#ifndef GAMES_SPRITE_ATLAS_HPP
+#define GAMES_SPRITE_ATLAS_HPP
+
+#include <vector>       // std::vector
+#include <string>       // std::string
+#include <string_view>  // std::string_view
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+
+// A list of rectangles to draw, each as 2 triangles, that's drawn with a single SDL_RenderGeometry call. Every quad of a batch uses the same texture
+// (or none, to draw plain colored rectangles). The vertex arrays are reused from frame to frame, so once they've grown big enough, nothing is allocated.
+class quad_batch
+{
+    std::vector<SDL_Vertex> m_vertices;
+    std::vector<int> m_indices;
+
+public:
+    void clear();  // Removes every quad (but keeps the memory)
+    void add(const SDL_FRect &dst, SDL_Color color);  // Adds a plain colored rectangle
+    void add(const SDL_FRect &dst, const SDL_Rect &src, int texWidth, int texHeight, SDL_Color color);  // Adds the src part of a texture of the given size, tinted by color
+    std::size_t size() const;  // How many quads there are
+    void draw(SDL_Renderer *renderer, SDL_Texture *texture) const;  // Draws every quad, in one call (or none, if the batch is empty)
+};
+
+// Several images, packed into one texture, so that all of them can be drawn with a single call (see quad_batch). Each one is found by its file name.
+class sprite_atlas
+{
+    SDL_Texture *m_texture;
+    int m_width, m_height;  // The size of the texture
+    std::vector<std::string> m_names;  // The file names of the sprites...
+    std::vector<SDL_Rect> m_regions;  // ...and where they ended up in the texture
+
+    void pack(SDL_Renderer *renderer, const std::vector<SDL_Surface*> &surfaces);  // Packs the images, uploads the atlas, and frees the images
+
+public:
+    sprite_atlas(SDL_Renderer *renderer, const std::vector<std::string> &paths);  // Loads every image and uploads the atlas
+    // Packs images that were loaded already (surfaces[i] being the image from paths[i]) and uploads the atlas. It takes over the surfaces, and frees
+    // them (even if it throws). This is how the asset cache makes atlases of images that its workers loaded
+    sprite_atlas(SDL_Renderer *renderer, const std::vector<std::string> &paths, const std::vector<SDL_Surface*> &surfaces);
+    sprite_atlas(const sprite_atlas &) = delete;  // We don't allow copying it, it owns the texture
+    ~sprite_atlas();
+
+    SDL_Rect region(std::string_view name) const;  // Gives the part of the texture that the image was put in. Throws std::out_of_range if it isn't there
+    SDL_Texture *texture() const;
+    int width() const;
+    int height() const;
+};
+
+#endif  // GAMES_SPRITE_ATLAS_HPP
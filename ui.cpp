@@ -31,7 +31,7 @@ namespace ui
             // And it's the left button...
             if (event.button.button == SDL_BUTTON_LEFT) {
                 int x, y;
-                sdlCall(SDL_GetMouseState)(&x, &y);
+                sdlCallUnchecked(SDL_GetMouseState)(&x, &y);
                 // And the mouse overlaps the widget's bounding box...
                 if (aabb_overlap(get_bounding_box(), { x, y, 1, 1 }))
                     // ...then a click has occured -- invoke all the handlers.
@@ -50,22 +50,27 @@ namespace ui
 
 
     // The constructor for the text widget
-    text::text(SDL_Renderer *renderer, int x, int y, TTF_Font *font, std::string_view text, SDL_Color fg, SDL_Color bg)
-        : widget{renderer, x, y, 0, 0, bg}, m_fg{fg}  // We delegate most work to the base constructor
+    text::text(SDL_Renderer *renderer, int x, int y, const font_atlas &font, std::string_view text, SDL_Color fg, SDL_Color bg)
+        : widget{renderer, x, y, 0, 0, bg}, m_font{font}, m_fg{fg}  // We delegate most work to the base constructor
     {
         // Updating the text is very simple!
-        update_text(renderer, font, text, fg, m_tex, m_w, m_h);
+        set_text(text);
     }
 
-    void text::draw() const
+    void text::set_text(std::string_view text)
     {
-        // Drawing is not too hard either, thanks to get_bounding_box we can make the method more readable
+        // Nothing is rendered here, the widget just needs to know its new size
+        m_text = text;
+        m_w = m_font.measure(m_text);
+        m_h = m_font.height();
+    }
+
+    void text::draw(render_queue &queue) const
+    {
+        // Drawing is not too hard either, thanks to get_bounding_box we can make the method more readable. The text goes on a layer above the background
         SDL_Rect dstrect = get_bounding_box();
-        SDL_Rect srcrect = dstrect;
-        srcrect.x = srcrect.y = 0;
-        sdlCall(SDL_SetRenderDrawColor)(m_renderer, m_bg.r, m_bg.g, m_bg.b, m_bg.a);
-        sdlCall(SDL_RenderFillRect)(m_renderer, &dstrect);
-        sdlCall(SDL_RenderCopy)(m_renderer, m_tex, &srcrect, &dstrect);
+        queue.fill_rect(0, dstrect, m_bg);
+        m_font.draw(queue, 1, m_text, dstrect.x, dstrect.y, m_fg);
     }
 
 
@@ -96,11 +101,11 @@ namespace ui
         m_widgets.erase(iter);
     }
 
-    void widget_list::draw() const
+    void widget_list::draw(render_queue &queue) const
     {
         // Drawing is trivial as well -- like on_event, we simply propagate it to all widgets in the list.
         for (auto &widgetPtr : m_widgets) {
-            widgetPtr->draw();
+            widgetPtr->draw(queue);
         }
     }
 }
@@ -6,6 +6,9 @@
 #include <string_view>
 #include <algorithm>
 #include <functional>
+#include <string>
+
+#include "font_atlas.hpp"
 
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
@@ -38,19 +41,21 @@ namespace ui
         void bind_mouse_click(std::function<void()> handler);  // A method to add a function to the list of functions to call on click
         void on_event(const SDL_Event &event);  // A method that should be called whenever the game window receives an event
         SDL_Rect get_bounding_box() const;  // A method to query the bounding box of the widget on-screen
-        virtual void draw() const = 0;  // An abstract method that draws the widget, it's supposed to be overriden
+        virtual void draw(render_queue &queue) const = 0;  // An abstract method that draws the widget, it's supposed to be overriden
     };
 
-    // A text widget
+    // A text widget. It's drawn from a font_atlas, so changing the text is cheap enough to do every frame
     class text : public widget
     {
-        SDL_Texture *m_tex = nullptr;  // The cached texture
+        const font_atlas &m_font;  // The font it's drawn with
+        std::string m_text;  // The text shown
         SDL_Color m_fg;  // The color of the text
 
     public:
         // The constructor; instead of accepting a size, it accepts a font, some text, and a color
-        text(SDL_Renderer *renderer, int x, int y, TTF_Font *font, std::string_view text, SDL_Color fg, SDL_Color bg);
-        void draw() const override;  // We override the drawing function, as is required by the base widget class
+        text(SDL_Renderer *renderer, int x, int y, const font_atlas &font, std::string_view text, SDL_Color fg, SDL_Color bg);
+        void set_text(std::string_view text);  // Changes the text shown (the widget is resized to fit it, staying centered)
+        void draw(render_queue &queue) const override;  // We override the drawing function, as is required by the base widget class
     };
 
     // A class that contains and manages a list of widgets
@@ -73,7 +78,7 @@ namespace ui
         }
         void remove_widget(const widget &w); // A method to remove a widget from the list
 
-        void draw() const;  // A function that should be called to draw the widgets on-screen
+        void draw(render_queue &queue) const;  // A function that should be called to draw the widgets on-screen
     };
 }
 
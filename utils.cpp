@@ -1,4 +1,6 @@
 #include "utils.hpp"
+#include <cmath>      // INFINITY
+#include <algorithm>  // std::min, std::max
 
 // All the constructor of sdl_error needs to do is to save the error string somewhere
 sdl_error::sdl_error(const char *what)
@@ -11,58 +13,54 @@ const char *sdl_error::what() const throw()
     return m_what;
 }
 
-/*
- * Utility function for creating a new texture with new text in place of an old one
- */
-void update_text(SDL_Renderer *renderer, TTF_Font *font, std::string_view newText, SDL_Color color, SDL_Texture *&textOut, int &textWidth, int &textHeight)
-{
-    // Simply delegate to render_text
-    SDL_Texture *newTexture = render_text(renderer, font, newText, color, textWidth, textHeight);
-    if (textOut)  // Only destroy the old texture if render_text succeeded
-        sdlCall(SDL_DestroyTexture)(textOut);
-    // Replace the old texture with the new one
-    textOut = newTexture;
-}
-SDL_Texture *render_text(SDL_Renderer *renderer, TTF_Font *font, std::string_view newText, SDL_Color color)
-{
-    // This is a bit lazy -- we just call the version that does SDL_QueryTexture, but ignore the width and height that it gathers.
-    int w, h;
-    return render_text(renderer, font, newText, color, w, h);
-}
-SDL_Texture *render_text(SDL_Renderer *renderer, TTF_Font *font, std::string_view newText, SDL_Color color, int &textWidth, int &textHeight)
+bool aabb_overlap(const SDL_Rect &rect1, const SDL_Rect &rect2)
 {
-    // Use the SDL_ttf library to render the text into an SDL_Surface
-    SDL_Surface *textSurface = sdlCall(TTF_RenderText_Solid)(font, newText.data(), color);
-
-    // Turn that CPU-bound SDL_Surface into a GPU-bound SDL_Texture
-    SDL_Texture *result = sdlCall(SDL_CreateTextureFromSurface)(renderer, textSurface);
-    sdlCall(SDL_FreeSurface)(textSurface);  // The data is copied, we don't need the surface anymore
-
-    // Gather the texture's size, and store it in textWidth and textHeight
-    uint32_t _1;
-    int _2;
-    sdlCall(SDL_QueryTexture)(result, &_1, &_2, &textWidth, &textHeight);
-
-    // Return the texture
-    return result;
+    // Two rectangles are apart if one of them ends before the other one starts, on either axis. The edges are inclusive, so rectangles that only
+    // touch still overlap. The bitwise ORs (instead of ||) keep this free of branches.
+    bool apart = (rect1.x > rect2.x + rect2.w) | (rect2.x > rect1.x + rect1.w) | (rect1.y > rect2.y + rect2.h) | (rect2.y > rect1.y + rect1.h);
+    return !apart;
 }
 
-bool aabb_overlap(const SDL_Rect &rect1, const SDL_Rect &rect2)
+bool swept_aabb(const SDL_FRect &moving, float dx, float dy, const SDL_Rect &target, float &time, int &normalX, int &normalY)
 {
-    // This is quite bad. What else can I say
-    auto checkContainedInRange = [](int start, int end, int num)
+    // On each axis separately, figure out the span of time during which the rectangles overlap on that axis. The time is in "fractions of the movement",
+    // so 0 is where the moving rectangle starts, and 1 is where it ends up. If it's not moving on an axis, it either always or never overlaps on it.
+    auto axisOverlap = [](float start, float size, float velocity, float targetStart, float targetSize, float &entry, float &exit)
     {
-        return num >= start && num <= end;
+        if (velocity > 0) {
+            entry = (targetStart - (start + size)) / velocity;
+            exit = (targetStart + targetSize - start) / velocity;
+        } else if (velocity < 0) {
+            entry = (targetStart + targetSize - start) / velocity;
+            exit = (targetStart - (start + size)) / velocity;
+        } else {
+            if (start + size <= targetStart || start >= targetStart + targetSize)
+                return false;
+            entry = -INFINITY;
+            exit = INFINITY;
+        }
+        return true;
     };
-    bool overlapX = checkContainedInRange(rect1.x, rect1.x + rect1.w, rect2.x);
-    overlapX |= checkContainedInRange(rect1.x, rect1.x + rect1.w, rect2.x + rect2.w);
-    overlapX |= checkContainedInRange(rect2.x, rect2.x + rect2.w, rect1.x);
-    overlapX |= checkContainedInRange(rect2.x, rect2.x + rect2.w, rect1.x + rect1.w);
 
-    bool overlapY = checkContainedInRange(rect1.y, rect1.y + rect1.h, rect2.y);
-    overlapY |= checkContainedInRange(rect1.y, rect1.y + rect1.h, rect2.y + rect2.h);
-    overlapY |= checkContainedInRange(rect2.y, rect2.y + rect2.h, rect1.y);
-    overlapY |= checkContainedInRange(rect2.y, rect2.y + rect2.h, rect1.y + rect1.h);
+    float entryX, exitX, entryY, exitY;
+    if (!axisOverlap(moving.x, moving.w, dx, target.x, target.w, entryX, exitX))
+        return false;
+    if (!axisOverlap(moving.y, moving.h, dy, target.y, target.h, entryY, exitY))
+        return false;
+
+    // The rectangles overlap once they overlap on both axes, and stop as soon as they stop overlapping on either
+    float entry = std::max(entryX, entryY), exit = std::min(exitX, exitY);
+    if (entry >= exit || exit <= 0 || entry > 1)
+        return false;
 
-    return overlapX && overlapY;
+    time = std::max(entry, 0.0f);
+    // The axis that started overlapping last is the one whose face got hit
+    if (entryX > entryY) {
+        normalX = dx > 0 ? -1 : 1;
+        normalY = 0;
+    } else {
+        normalX = 0;
+        normalY = dy > 0 ? -1 : 1;
+    }
+    return true;
 }
@@ -6,6 +6,7 @@
 #include <exception>    // std::exception
 #include <string_view>  // std::string_view
 #include <vector>       // std::vector
+#include <type_traits>  // std::is_same_v, std::is_pointer_v
 
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
@@ -14,10 +15,16 @@
 
 const int SCREEN_WIDTH = 1080, SCREEN_HEIGHT = 810;
 
-// This function calculates if 2 axis-aligned rectangles overlap
+// This function calculates if 2 axis-aligned rectangles overlap. Rectangles that only touch at the edges count as overlapping.
 bool aabb_overlap(const SDL_Rect &rect1, const SDL_Rect &rect2);
 
-// This function does what the previous function did, but for a list of rectangles. It's a template function, because of the `auto` argument, and so it has to be
+// This function finds out when a rectangle moving by (dx, dy) first touches another rectangle, which stands still. If that happens during the movement,
+// it returns true, sets `time` to how much of the movement (0 to 1) is done at the moment of impact, and sets normalX and normalY to the direction that
+// the face that got hit points in (one of them is -1 or 1, the other one is 0). Rectangles that already overlap are hit at time 0, on the face that was
+// crossed last. Rectangles that only touch and are moving apart aren't hit.
+bool swept_aabb(const SDL_FRect &moving, float dx, float dy, const SDL_Rect &target, float &time, int &normalX, int &normalY);
+
+// This function does what the first function did, but for a list of rectangles. It's a template function, because of the `auto` argument, and so it has to be
 // in the header file. The function assumes that the passed type is an iterator via duck typing, not through concepts, despite us having access to those via C++20
 // (mostly because the ranges library is very esoteric)
 bool aabb_overlap_all(const auto &rects)
@@ -35,15 +42,6 @@ bool aabb_overlap_all(const auto &rects)
     return false;
 }
 
-// Helper function to overlap two lists of rectangles, as if they were one list. Unbelieveable that C++ STILL doesn't feature simple collection concatenation.
-bool aabb_overlap_all(const auto &rectsList1, const auto &rectsList2)
-{
-    std::vector<SDL_Rect> rects;
-    rects.insert(rects.end(), std::begin(rectsList1), std::end(rectsList1));
-    rects.insert(rects.end(), std::begin(rectsList2), std::end(rectsList2));
-    return aabb_overlap_all(rects);
-}
-
 // A class that describes an error thrown by SDL
 class sdl_error : public std::exception
 {
@@ -53,17 +51,47 @@ public:
     const char *what() const throw();
 };
 
-// Helper function to "update" a texture containing text with some new text
-void update_text(SDL_Renderer *renderer, TTF_Font *font, std::string_view newText, SDL_Color color, SDL_Texture *&textOut, int &textWidth, int &textHeight);
+// How much checking sdlCall does after calling an SDL function:
+//  - full: the SDL error string is cleared before the call and checked after it, so that any error SDL reports gets thrown, whatever the function
+//    returned. It costs two more calls into SDL (which touch thread-local state) for every wrapped call.
+//  - return_code: only the returned value is looked at, and compared with the value that the SDL documentation gives for a failure -- negative for
+//    functions returning int, NULL for functions returning a pointer. Functions returning void, an unsigned number or SDL_bool can't fail this way, and
+//    aren't checked at all. When a call fails, the SDL error string is thrown, just like in the full mode.
+//  - none: the function is called as is.
+enum class sdl_check
+{
+    none,
+    return_code,
+    full,
+};
+
+// Which of the above sdlCall uses. Debug builds check everything, release builds (built with NDEBUG, see the Makefile) only check return codes. It can
+// also be picked by hand, with -DGAMES_SDL_CHECK=0 (none), 1 (return_code) or 2 (full).
+#ifndef GAMES_SDL_CHECK
+#ifdef NDEBUG
+#define GAMES_SDL_CHECK 1
+#else
+#define GAMES_SDL_CHECK 2
+#endif
+#endif
+constexpr sdl_check SDL_CHECK = (sdl_check)GAMES_SDL_CHECK;
 
-// Helper functions to render text into a texture
-SDL_Texture *render_text(SDL_Renderer *renderer, TTF_Font *font, std::string_view newText, SDL_Color color);
-// This one also lets you get the texture's size without having to manually call SDL_QueryTexture
-SDL_Texture *render_text(SDL_Renderer *renderer, TTF_Font *font, std::string_view newText, SDL_Color color, int &textWidth, int &textHeight);
+// Tells whether a value returned by an SDL function means that the call failed, according to its type (see sdl_check::return_code)
+template<typename T>
+constexpr bool sdl_failed(T value)
+{
+    if constexpr (std::is_pointer_v<T>)
+        return value == NULL;
+    else if constexpr (std::is_same_v<T, int>)
+        return value < 0;
+    else
+        return false;
+}
 
 // This is a template function, and so it has to be defined in the header. Its purpose is to wrap around SDL functions, adding exception support to them, so that
-// you do not have to constantly check return values and error states like you would in C. This does that for you, automatically.
-template<typename ReturnType, typename ...ArgTypes>
+// you do not have to constantly check return values and error states like you would in C. This does that for you, automatically. How much it checks is
+// decided at compile time, by the Check parameter (see sdl_check), so the checks that aren't done don't cost anything.
+template<sdl_check Check = SDL_CHECK, typename ReturnType, typename ...ArgTypes>
 constexpr auto sdlCall(ReturnType (*func)(ArgTypes...))  // We declare the function as constexpr, as it's fully possible to evaluate at compile-time -- all it does is return a lambda.
 {
     // NOTE: I decided against perfect forwarding as it prevents automatic casts for some reason (A design choice that I would swiftly give up on, but I don't have time to fix)
@@ -71,27 +99,47 @@ constexpr auto sdlCall(ReturnType (*func)(ArgTypes...))  // We declare the funct
     // on the parameters that the function pointer takes
     return [func](ArgTypes... args)
     {
-        // First, we clear any error. This sets the error string to "".
-        SDL_ClearError();
-        // C++ is a bit annoying, sadly -- void is an incomplete type, and so we can't have a variable of that type, and so we need 2 cases for when the function returns void, and when it doesn't.
-        // Thankfully, we don't have to work with SFINAE, as `if constexpr` allows us to easily check types
-        if constexpr (std::is_same_v<ReturnType, void>) {
-            // Call the original SDL function with the specified arguments
-            func(args ...);
-            // Collect the current SDL error
-            const char *err = SDL_GetError();
-            if (err[0] != 0)  // If it's not empty,
-                throw sdl_error(err);  // then throw it as an exception.
+        if constexpr (Check == sdl_check::full) {
+            // First, we clear any error. This sets the error string to "".
+            SDL_ClearError();
+            // C++ is a bit annoying, sadly -- void is an incomplete type, and so we can't have a variable of that type, and so we need 2 cases for when the function returns void, and when it doesn't.
+            // Thankfully, we don't have to work with SFINAE, as `if constexpr` allows us to easily check types
+            if constexpr (std::is_same_v<ReturnType, void>) {
+                // Call the original SDL function with the specified arguments
+                func(args ...);
+                // Collect the current SDL error
+                const char *err = SDL_GetError();
+                if (err[0] != 0)  // If it's not empty,
+                    throw sdl_error(err);  // then throw it as an exception.
+
+            } else {
+                decltype(auto) value = func(args ...);  // Call the original SDL function with the specified arguments, and collect its result
+                // Same as above
+                const char *err = SDL_GetError();
+                if (err[0] != 0)
+                    throw sdl_error(err);
+                return value;  // Return the result of the SDL function call
+            }
+
+        } else if constexpr (Check == sdl_check::return_code && !std::is_same_v<ReturnType, void>) {
+            decltype(auto) value = func(args ...);
+            // SDL sets the error string whenever it fails, so it's still there to throw
+            if (sdl_failed(value))
+                throw sdl_error(SDL_GetError());
+            return value;
 
         } else {
-            decltype(auto) value = func(args ...);  // Call the original SDL function with the specified arguments, and collect its result
-            // Same as above
-            const char *err = SDL_GetError();
-            if (err[0] != 0)
-                throw sdl_error(err);
-            return value;  // Return the result of the SDL function call
+            // Nothing to check, this should compile down to just calling the function
+            return func(args ...);
         }
     };
 }
 
+// Wraps an SDL function that can't fail (like SDL_GetPerformanceCounter), to make it clear that it's never checked, whatever SDL_CHECK is
+template<typename ReturnType, typename ...ArgTypes>
+constexpr auto sdlCallUnchecked(ReturnType (*func)(ArgTypes...))
+{
+    return sdlCall<sdl_check::none>(func);
+}
+
 #endif  // GAMES_UTILS_HPP